@@ -0,0 +1,175 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Marco Blok
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// analysis.c
+#include "analysis.h"
+#include <stdlib.h>
+
+static const char* reject_names[] = {
+    "cycles possible",
+    "fewer vertices than the cycle length",
+    "bipartite, odd cycle length",
+    "bipartite, sides too small for the cycle length",
+    "girth above the cycle length"
+};
+
+const char* reject_reason(CycleReject reason) {
+    return reject_names[reason];
+}
+
+// Two-colors every connected component of the underlying undirected graph.
+// Returns 1 if the graph is bipartite, with *longest set to the longest cycle
+// any component could hold: twice its smaller side.
+static int bipartite(const Graph *g, int *color, int *queue, int *longest) {
+    int n = g->n;
+    *longest = 0;
+    for (int v = 0; v < n; v++) color[v] = -1;
+
+    for (int root = 0; root < n; root++) {
+        if (color[root] >= 0 || g->degrees[root] == 0) continue;
+        int head = 0, tail = 0, side[2] = {1, 0};
+        color[root] = 0;
+        queue[tail++] = root;
+        while (head < tail) {
+            int x = queue[head++];
+            for (int dir = 0; dir < (g->directed ? 2 : 1); dir++) {
+                const size_t *offsets = dir ? g->in_offsets : g->offsets;
+                const int *neighbors = dir ? g->in_neighbors : g->neighbors;
+                for (size_t e = offsets[x]; e < offsets[x + 1]; e++) {
+                    int w = neighbors[e];
+                    if (color[w] == color[x]) return 0;
+                    if (color[w] >= 0) continue;
+                    color[w] = !color[x];
+                    side[color[w]]++;
+                    queue[tail++] = w;
+                }
+            }
+        }
+        int bound = 2 * (side[0] < side[1] ? side[0] : side[1]);
+        if (bound > *longest) *longest = bound;
+    }
+    return 1;
+}
+
+// Returns 1 if an undirected cycle of at most k edges passes near source: a
+// non-tree edge between levels of the search closes a walk of
+// dist[x] + dist[w] + 1 edges, which contains such a cycle. A shortest cycle
+// is found from any of its vertices within k / 2 levels.
+static int short_cycle_from(const Graph *g, int source, int k, int *queue, int *dist, int *parent) {
+    int head = 0, tail = 0, found = 0;
+    dist[source] = 0;
+    parent[source] = -1;
+    queue[tail++] = source;
+    while (head < tail && !found) {
+        int x = queue[head++];
+        for (size_t e = g->offsets[x]; e < g->offsets[x + 1] && !found; e++) {
+            int w = g->neighbors[e];
+            if (dist[w] < 0) {
+                dist[w] = dist[x] + 1;
+                parent[w] = x;
+                if (2 * dist[w] <= k) queue[tail++] = w;
+            } else if (w != parent[x]) {
+                found = dist[x] + dist[w] + 1 <= k;
+            }
+        }
+    }
+
+    // Reset the vertices reached, which all passed through the queue or are
+    // neighbors of it
+    for (int i = 0; i < tail; i++) {
+        int x = queue[i];
+        dist[x] = -1;
+        for (size_t e = g->offsets[x]; e < g->offsets[x + 1]; e++) dist[g->neighbors[e]] = -1;
+    }
+    return found;
+}
+
+// Returns 1 if a directed cycle of at most k arcs passes through source.
+static int short_arc_cycle_from(const Graph *g, int source, int k, int *queue, int *dist) {
+    int head = 0, tail = 0, found = 0;
+    dist[source] = 0;
+    queue[tail++] = source;
+    while (head < tail && !found) {
+        int x = queue[head++];
+        for (size_t e = g->offsets[x]; e < g->offsets[x + 1] && !found; e++) {
+            int w = g->neighbors[e];
+            if (w == source) {
+                found = 1;
+            } else if (dist[w] < 0) {
+                dist[w] = dist[x] + 1;
+                if (dist[w] < k) queue[tail++] = w;
+            }
+        }
+    }
+
+    for (int i = 0; i < tail; i++) {
+        int x = queue[i];
+        dist[x] = -1;
+        for (size_t e = g->offsets[x]; e < g->offsets[x + 1]; e++) dist[g->neighbors[e]] = -1;
+    }
+    return found;
+}
+
+// Tries the cheapest bounds first; the girth search stops at the first short cycle.
+CycleReject reject_cycle_length(const Graph *g, int k) {
+    if (g->backend == GRAPH_COMPRESSED) return CYCLES_POSSIBLE;
+
+    int n = g->n, active = 0;
+    for (int v = 0; v < n; v++) active += g->degrees[v] > 0;
+    if (active < k) return REJECT_TOO_SMALL;
+
+    int *queue = malloc((n ? n : 1) * sizeof(int));
+    int *dist = malloc((n ? n : 1) * sizeof(int));
+    int *parent = malloc((n ? n : 1) * sizeof(int));
+    if (!queue || !dist || !parent) {
+        free(queue);
+        free(dist);
+        free(parent);
+        return CYCLES_POSSIBLE;
+    }
+
+    CycleReject reason = CYCLES_POSSIBLE;
+    int longest;
+    if (bipartite(g, dist, queue, &longest)) {
+        if (k % 2) reason = REJECT_BIPARTITE_ODD;
+        else if (k > longest) reason = REJECT_BIPARTITE_SIDES;
+    }
+
+    // Undirected cycles of two edges are the edges themselves
+    if (reason == CYCLES_POSSIBLE && (g->directed || k >= 3)) {
+        for (int v = 0; v < n; v++) dist[v] = -1;
+        int found = 0;
+        for (int v = 0; v < n && !found; v++) {
+            if (g->degrees[v] == 0) continue;
+            found = g->directed ? short_arc_cycle_from(g, v, k, queue, dist)
+                                : short_cycle_from(g, v, k, queue, dist, parent);
+        }
+        if (!found) reason = REJECT_GIRTH;
+    }
+
+    free(queue);
+    free(dist);
+    free(parent);
+    return reason;
+}
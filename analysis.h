@@ -0,0 +1,64 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Marco Blok
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// analysis.h
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include "graph.h"
+
+/**
+ * @brief Reasons why a graph provably has no cycle of the requested length.
+ */
+typedef enum {
+    CYCLES_POSSIBLE,        // No reason found; the cycles must be enumerated
+    REJECT_TOO_SMALL,       // Fewer vertices with arcs than the cycle length
+    REJECT_BIPARTITE_ODD,   // Bipartite, so every cycle has even length
+    REJECT_BIPARTITE_SIDES, // Bipartite, and every cycle alternates between too few vertices on one side
+    REJECT_GIRTH            // The shortest cycle is longer than the cycle length
+} CycleReject;
+
+/**
+ * @brief Checks cheap structural bounds that rule out cycles of length k.
+ *
+ * In order: the number of vertices with arcs, bipartiteness of the underlying
+ * undirected graph (odd k, or k above twice the smaller side of every
+ * connected component) and the girth, found with a breadth-first search from
+ * every vertex that stops at the first cycle of length k or less. The searches
+ * are bounded by k / 2 levels (k - 1 arcs if directed) and visit no more
+ * vertices than the path enumeration would.
+ *
+ * @param g         The graph; its neighbor arrays are used (not GRAPH_COMPRESSED,
+ *                  for which CYCLES_POSSIBLE is returned).
+ * @param k         Length of the cycles searched for.
+ * @return          The first reason found, or CYCLES_POSSIBLE (also on allocation failure).
+ */
+CycleReject reject_cycle_length(const Graph *g, int k);
+
+/**
+ * @brief Returns a short description of the reason.
+ */
+const char* reject_reason(CycleReject reason);
+
+#endif // ANALYSIS_H
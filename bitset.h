@@ -0,0 +1,59 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Marco Blok
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// bitset.h
+#ifndef BITSET_H
+#define BITSET_H
+
+#include <stdint.h>
+
+/**
+ * @brief Number of 64-bit words needed to hold n bits.
+ */
+static inline int bitset_words(int n) {
+    return (n + 63) >> 6;
+}
+
+/**
+ * @brief Returns non-zero if bit i is set.
+ */
+static inline int bitset_test(const uint64_t *bits, int i) {
+    return (bits[i >> 6] >> (i & 63)) & 1;
+}
+
+/**
+ * @brief Sets bit i.
+ */
+static inline void bitset_set(uint64_t *bits, int i) {
+    bits[i >> 6] |= 1ULL << (i & 63);
+}
+
+/**
+ * @brief Clears bit i.
+ */
+static inline void bitset_clear(uint64_t *bits, int i) {
+    bits[i >> 6] &= ~(1ULL << (i & 63));
+}
+
+#endif // BITSET_H
\ No newline at end of file
@@ -0,0 +1,444 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Marco Blok
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// chains.c
+#include "chains.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Copies the row of v into out, decoding it with the compressed backend.
+static void read_row(const Graph *g, int v, int *out) {
+    if (g->backend == GRAPH_COMPRESSED) {
+        PackedRow row = graph_packed_row(g, v, 0);
+        int w, i = 0;
+        while (packed_row_next(&row, &w)) out[i++] = w;
+        return;
+    }
+    memcpy(out, g->neighbors + g->offsets[v], graph_out_degree(g, v) * sizeof(int));
+}
+
+// Stores the cycle of k edges in vertices[0 .. k) unless already present.
+static void add_cycle(CycleSetEntry **cycles, int *cycle_count, int *vertices, int k) {
+    vertices[k] = vertices[0];
+    int *canon = canonical_cycle(vertices, k);
+    if (cycle_already_seen(*cycles, canon, k + 1)) {
+        free(canon);
+        return;
+    }
+    store_cycle(cycles, canon, k + 1);
+    (*cycle_count)++;
+}
+
+void free_chain_graph(ChainGraph *c) {
+    if (!c) return;
+    free(c->vertex);
+    free(c->offsets);
+    free(c->arcs);
+    free(c->chain_from);
+    free(c->chain_to);
+    free(c->chain_length);
+    free(c->chain_offsets);
+    free(c->interior);
+    free(c);
+}
+
+// Walks every chain from both of its branch vertices and keeps it from the
+// lower one; a chain back to the same branch vertex is kept from the end whose
+// first interior vertex is lower. Degree-2 vertices no walk reached form
+// cycles of their own. The arcs are then bucketed by branch vertex.
+ChainGraph* contract_chains(const Graph *g, int k, CycleSetEntry **cycles, int *cycle_count) {
+    int n = g->n;
+    size_t max_chains = g->m / 2 + 1;
+
+    // Row lengths cost a row decode with the compressed backend, so take them once
+    int *degree = malloc((n ? n : 1) * sizeof(int));
+    if (!degree) return NULL;
+    int max_degree = 2;
+    for (int v = 0; v < n; v++) {
+        degree[v] = graph_out_degree(g, v);
+        if (degree[v] > max_degree) max_degree = degree[v];
+    }
+
+    ChainGraph *c = calloc(1, sizeof(ChainGraph));
+    int *index = malloc((n ? n : 1) * sizeof(int));
+    unsigned char *visited = calloc(n ? n : 1, 1);
+    int *row = malloc(max_degree * sizeof(int));
+    int *cycle = malloc((n + 1) * sizeof(int));
+    if (c) {
+        c->vertex = malloc((n ? n : 1) * sizeof(int));
+        c->chain_from = malloc(max_chains * sizeof(int));
+        c->chain_to = malloc(max_chains * sizeof(int));
+        c->chain_length = malloc(max_chains * sizeof(int));
+        c->chain_offsets = malloc((max_chains + 1) * sizeof(size_t));
+        // A walk may repeat the vertices of a chain kept from its other end
+        c->interior = malloc((2 * (size_t)n + 1) * sizeof(int));
+    }
+    if (!c || !index || !visited || !row || !cycle || !c->vertex || !c->chain_from || !c->chain_to ||
+        !c->chain_length || !c->chain_offsets || !c->interior) {
+        free_chain_graph(c);
+        free(degree);
+        free(index);
+        free(visited);
+        free(row);
+        free(cycle);
+        return NULL;
+    }
+
+    for (int v = 0; v < n; v++) {
+        index[v] = -1;
+        if (degree[v] > 0 && degree[v] != 2) {
+            index[v] = c->n;
+            c->vertex[c->n++] = v;
+        }
+    }
+
+    size_t used = 0;
+    c->chain_offsets[0] = 0;
+    for (int b = 0; b < c->n; b++) {
+        int u = c->vertex[b];
+        read_row(g, u, row);
+
+        for (int i = 0; i < degree[u]; i++) {
+            // Follow the degree-2 vertices up to the next branch vertex
+            int prev = u, cur = row[i];
+            int length = 1;
+            size_t begin = used;
+            while (index[cur] < 0) {
+                int pair[2];
+                read_row(g, cur, pair);
+                visited[cur] = 1;
+                c->interior[used++] = cur;
+                int next = pair[0] == prev ? pair[1] : pair[0];
+                prev = cur;
+                cur = next;
+                length++;
+            }
+            int to = index[cur];
+
+            if (to == b && used - begin >= 2 && c->interior[begin] < c->interior[used - 1] && length == k) {
+                // A loop through one branch vertex is a cycle by itself
+                cycle[0] = u;
+                memcpy(cycle + 1, c->interior + begin, (used - begin) * sizeof(int));
+                add_cycle(cycles, cycle_count, cycle, k);
+            }
+            if (to <= b || length >= k) {
+                used = begin;
+                continue;
+            }
+            c->chain_from[c->chains] = b;
+            c->chain_to[c->chains] = to;
+            c->chain_length[c->chains] = length;
+            c->chain_offsets[++c->chains] = used;
+        }
+    }
+
+    // Cycles without any branch vertex
+    for (int v = 0; v < n; v++) {
+        if (visited[v] || degree[v] != 2) continue;
+        int length = 0, prev = -1, cur = v;
+        do {
+            int pair[2];
+            read_row(g, cur, pair);
+            visited[cur] = 1;
+            cycle[length++] = cur;
+            int next = pair[0] == prev ? pair[1] : pair[0];
+            prev = cur;
+            cur = next;
+        } while (cur != v);
+        if (length == k) add_cycle(cycles, cycle_count, cycle, k);
+    }
+
+    free(degree);
+    free(index);
+    free(visited);
+    free(row);
+    free(cycle);
+
+    // Bucket both directions of every chain by their first branch vertex
+    c->offsets = calloc(c->n + 1, sizeof(size_t));
+    c->arcs = malloc((2 * (size_t)c->chains + 1) * sizeof(int));
+    if (!c->offsets || !c->arcs) {
+        free_chain_graph(c);
+        return NULL;
+    }
+    for (int i = 0; i < c->chains; i++) {
+        c->offsets[c->chain_from[i] + 1]++;
+        c->offsets[c->chain_to[i] + 1]++;
+    }
+    for (int b = 0; b < c->n; b++) c->offsets[b + 1] += c->offsets[b];
+    for (int i = 0; i < c->chains; i++) {
+        c->arcs[c->offsets[c->chain_from[i]]++] = i;
+        c->arcs[c->offsets[c->chain_to[i]]++] = -i - 1;
+    }
+    for (int b = c->n; b > 0; b--) c->offsets[b] = c->offsets[b - 1];
+    c->offsets[0] = 0;
+
+    return c;
+}
+
+// Paths of one anchor, as runs of arcs in steps
+typedef struct {
+    size_t first;       // Offset of the first arc in steps
+    int arcs;           // Number of arcs
+    int length;         // Number of edges after expansion
+    int end;            // Last branch vertex
+} ChainPath;
+
+// Growable paths of one anchor
+typedef struct {
+    ChainPath *paths;
+    size_t count, capacity;
+    int *steps;
+    size_t used, step_capacity;
+} ChainPaths;
+
+// Appends the path given by the arc stack.
+static int record_path(ChainPaths *p, const int *stack, int arcs, int length, int end) {
+    if (p->count == p->capacity) {
+        size_t capacity = p->capacity ? 2 * p->capacity : 64;
+        ChainPath *grown = realloc(p->paths, capacity * sizeof(ChainPath));
+        if (!grown) return 0;
+        p->paths = grown;
+        p->capacity = capacity;
+    }
+    if (p->used + arcs > p->step_capacity) {
+        size_t capacity = p->step_capacity ? 2 * p->step_capacity : 256;
+        while (capacity < p->used + arcs) capacity *= 2;
+        int *grown = realloc(p->steps, capacity * sizeof(int));
+        if (!grown) return 0;
+        p->steps = grown;
+        p->step_capacity = capacity;
+    }
+    memcpy(p->steps + p->used, stack, arcs * sizeof(int));
+    p->paths[p->count++] = (ChainPath){p->used, arcs, length, end};
+    p->used += arcs;
+    return 1;
+}
+
+// Branch vertex an arc leads to
+static inline int arc_target(const ChainGraph *c, int arc) {
+    return arc >= 0 ? c->chain_to[arc] : c->chain_from[-arc - 1];
+}
+
+// Appends the interior vertices of the arc and the vertex it leads to, or,
+// with reverse set, those of the arc followed backwards.
+static int expand_arc(const ChainGraph *c, int arc, int reverse, int *out) {
+    int chain = arc >= 0 ? arc : -arc - 1;
+    int forward = (arc >= 0) != reverse;
+    size_t begin = c->chain_offsets[chain], end = c->chain_offsets[chain + 1];
+    int written = 0;
+    if (forward) {
+        for (size_t i = begin; i < end; i++) out[written++] = c->interior[i];
+        out[written++] = c->vertex[c->chain_to[chain]];
+    } else {
+        for (size_t i = end; i > begin; i--) out[written++] = c->interior[i - 1];
+        out[written++] = c->vertex[c->chain_from[chain]];
+    }
+    return written;
+}
+
+// Orders paths by end, then length
+static int compare_paths(const void *a, const void *b) {
+    const ChainPath *x = a, *y = b;
+    if (x->end != y->end) return (x->end > y->end) - (x->end < y->end);
+    return (x->length > y->length) - (x->length < y->length);
+}
+
+// Scratch arrays of the distance search; dist is INT_MAX outside of it
+typedef struct {
+    int *dist;          // Length of the shortest path back to the anchor
+    int *head;          // k buckets of queued vertices, by distance
+    int *queued;        // Vertex of every queue entry
+    int *next;          // Next entry in the same bucket
+} AnchorDistances;
+
+// Dial's algorithm: the lengths are small integers, so the queue is a bucket
+// per distance. Only branch vertices above the anchor are passed and distances
+// beyond k - 1 are not needed. Every arc queues at most one entry.
+static int anchor_distances(const ChainGraph *c, int anchor, int k, AnchorDistances *d) {
+    int entries = 0;
+    for (int i = 0; i < k; i++) d->head[i] = -1;
+    d->dist[anchor] = 0;
+    d->queued[entries] = anchor;
+    d->next[entries] = -1;
+    d->head[0] = entries++;
+
+    for (int dist = 0; dist < k; dist++) {
+        for (int e = d->head[dist]; e >= 0; e = d->next[e]) {
+            int b = d->queued[e];
+            if (d->dist[b] != dist) continue;
+            for (size_t i = c->offsets[b]; i < c->offsets[b + 1]; i++) {
+                int arc = c->arcs[i];
+                int x = arc_target(c, arc);
+                int total = dist + c->chain_length[arc >= 0 ? arc : -arc - 1];
+                if (x <= anchor || total > k - 1 || total >= d->dist[x]) continue;
+                d->dist[x] = total;
+                d->queued[entries] = x;
+                d->next[entries] = d->head[total];
+                d->head[total] = entries++;
+            }
+        }
+    }
+    return entries;
+}
+
+// Depth-first search over the arcs from the anchor, with the remaining length
+// as budget; a branch vertex is only entered if the shortest path from it back
+// to the anchor fits the budget left. Frames keep the branch vertex and the
+// next arc to follow.
+static int anchor_paths(const ChainGraph *c, int anchor, int k, ChainPaths *p, const int *dist,
+                        int *stack, int *frames, size_t *cursor, int *length, unsigned char *on_path) {
+    int top = 0;
+    frames[0] = anchor;
+    cursor[0] = c->offsets[anchor];
+    length[0] = 0;
+    on_path[anchor] = 1;
+
+    while (top >= 0) {
+        int b = frames[top];
+        if (cursor[top] == c->offsets[b + 1]) {
+            on_path[b] = 0;
+            top--;
+            continue;
+        }
+        int arc = c->arcs[cursor[top]++];
+        int x = arc_target(c, arc);
+        int total = length[top] + c->chain_length[arc >= 0 ? arc : -arc - 1];
+        if (x <= anchor || on_path[x] || dist[x] > k - total) continue;
+
+        stack[top] = arc;
+        if (!record_path(p, stack, top + 1, total, x)) {
+            while (top >= 0) on_path[frames[top--]] = 0;
+            return 0;
+        }
+        top++;
+        frames[top] = x;
+        cursor[top] = c->offsets[x];
+        length[top] = total;
+        on_path[x] = 1;
+    }
+    return 1;
+}
+
+// Joins every two paths of the anchor that end at the same branch vertex,
+// have lengths summing to k and share no interior branch vertex: the first is
+// expanded forwards, the second backwards.
+static void join_anchor_paths(const ChainGraph *c, int anchor, int k, ChainPaths *p,
+                              int *mark, int *stamp, int *cycle,
+                              CycleSetEntry **cycles, int *cycle_count) {
+    qsort(p->paths, p->count, sizeof(ChainPath), compare_paths);
+
+    for (size_t group = 0; group < p->count;) {
+        size_t group_end = group;
+        while (group_end < p->count && p->paths[group_end].end == p->paths[group].end) group_end++;
+
+        // Lengths increase within the group, so the partners of i follow it
+        for (size_t i = group; i < group_end; i++) {
+            const ChainPath *p1 = &p->paths[i];
+            if (2 * p1->length > k) break;
+            (*stamp)++;
+            for (int s = 0; s < p1->arcs - 1; s++) mark[arc_target(c, p->steps[p1->first + s])] = *stamp;
+
+            for (size_t j = i + 1; j < group_end; j++) {
+                const ChainPath *p2 = &p->paths[j];
+                if (p1->length + p2->length > k) break;
+                if (p1->length + p2->length < k) continue;
+
+                int disjoint = 1;
+                for (int s = 0; s < p2->arcs - 1 && disjoint; s++) {
+                    disjoint = mark[arc_target(c, p->steps[p2->first + s])] != *stamp;
+                }
+                if (!disjoint) continue;
+
+                int written = 0;
+                cycle[written++] = c->vertex[anchor];
+                for (int s = 0; s < p1->arcs; s++) {
+                    written += expand_arc(c, p->steps[p1->first + s], 0, cycle + written);
+                }
+                for (int s = p2->arcs - 1; s >= 0; s--) {
+                    written += expand_arc(c, p->steps[p2->first + s], 1, cycle + written);
+                }
+                add_cycle(cycles, cycle_count, cycle, k);
+            }
+        }
+        group = group_end;
+    }
+}
+
+// Contracts the chains and joins the paths of one anchor at a time.
+int find_chain_cycles(const Graph *g, int k, int verbose, int *path_count, int *cycle_count, CycleSetEntry **cycles) {
+    *path_count = 0;
+    *cycle_count = 0;
+    *cycles = NULL;
+
+    ChainGraph *c = contract_chains(g, k, cycles, cycle_count);
+    if (!c) return 0;
+    if (verbose) printf("contracted: %d branch vertices, %d chains\n", c->n, c->chains);
+
+    int n = c->n;
+    ChainPaths p = {0};
+    int *stack = malloc(k * sizeof(int));
+    int *frames = malloc(k * sizeof(int));
+    size_t *cursor = malloc(k * sizeof(size_t));
+    int *length = malloc(k * sizeof(int));
+    unsigned char *on_path = calloc(n ? n : 1, 1);
+    int *mark = calloc(n ? n : 1, sizeof(int));
+    int *cycle = malloc((k + 2) * sizeof(int));
+    AnchorDistances d;
+    d.dist = malloc((n ? n : 1) * sizeof(int));
+    d.head = malloc(k * sizeof(int));
+    d.queued = malloc((2 * (size_t)c->chains + 1) * sizeof(int));
+    d.next = malloc((2 * (size_t)c->chains + 1) * sizeof(int));
+    int ok = stack && frames && cursor && length && on_path && mark && cycle &&
+             d.dist && d.head && d.queued && d.next;
+    for (int b = 0; ok && b < n; b++) d.dist[b] = INT_MAX;
+
+    int stamp = 0;
+    for (int anchor = 0; ok && anchor < n; anchor++) {
+        p.count = 0;
+        p.used = 0;
+        int entries = anchor_distances(c, anchor, k, &d);
+        ok = anchor_paths(c, anchor, k, &p, d.dist, stack, frames, cursor, length, on_path);
+        for (int e = 0; e < entries; e++) d.dist[d.queued[e]] = INT_MAX;
+        *path_count += (int)p.count;
+        if (ok) join_anchor_paths(c, anchor, k, &p, mark, &stamp, cycle, cycles, cycle_count);
+    }
+
+    free(p.paths);
+    free(p.steps);
+    free(stack);
+    free(frames);
+    free(cursor);
+    free(length);
+    free(on_path);
+    free(mark);
+    free(cycle);
+    free(d.dist);
+    free(d.head);
+    free(d.queued);
+    free(d.next);
+    free_chain_graph(c);
+    return ok;
+}
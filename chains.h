@@ -0,0 +1,99 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Marco Blok
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// chains.h
+#ifndef CHAINS_H
+#define CHAINS_H
+
+#include "graph.h"
+#include "pathjoin.h"
+
+/**
+ * @brief Undirected graph with its chains of degree-2 vertices contracted.
+ *
+ * The branch vertices are the vertices whose degree is not 2. Every maximal
+ * path between two branch vertices whose interior vertices all have degree 2
+ * becomes one chain, stored once as interior[chain_offsets[c] .. chain_offsets[c + 1])
+ * in the direction from chain_from[c] to chain_to[c]; its length is the number
+ * of edges of the path. The arcs of branch vertex b are arcs[offsets[b] .. offsets[b + 1]),
+ * each following one chain in one direction. Two branch vertices may be joined
+ * by several chains.
+ */
+typedef struct {
+    int n;                  // Number of branch vertices
+    int *vertex;            // Vertex of the graph of every branch vertex
+    size_t *offsets;        // n + 1 row offsets into arcs
+    int *arcs;              // Chain of every arc, negated and minus one when followed backwards
+    int chains;             // Number of chains
+    int *chain_from;        // Branch vertex a chain starts at
+    int *chain_to;          // Branch vertex a chain ends at
+    int *chain_length;      // Number of edges of every chain
+    size_t *chain_offsets;  // chains + 1 offsets into interior
+    int *interior;          // Interior vertices of the chains, in graph ids
+} ChainGraph;
+
+/**
+ * @brief Contracts the chains of degree-2 vertices of an undirected graph.
+ *
+ * Chains of k or more edges cannot lie on a cycle of length k through two
+ * branch vertices and are left out. A chain that returns to its own branch
+ * vertex, and a cycle made of degree-2 vertices only, is a cycle on its own;
+ * those of length k are added to *cycles instead.
+ *
+ * @param g             The undirected graph; left unchanged.
+ * @param k             Length of the cycles searched for.
+ * @param cycles        Hash set receiving the cycles that need no branch vertex pair.
+ * @param cycle_count   Incremented for every cycle added.
+ * @return              Allocated chain graph, or NULL on allocation failure.
+ */
+ChainGraph* contract_chains(const Graph *g, int k, CycleSetEntry **cycles, int *cycle_count);
+
+/**
+ * @brief Frees the chain graph and its arrays.
+ */
+void free_chain_graph(ChainGraph *c);
+
+/**
+ * @brief Enumerates the cycles of length k of an undirected graph on its contracted chains.
+ *
+ * Every remaining cycle passes through at least two branch vertices. For every
+ * anchor a, the paths over the contracted graph that start at a, only visit
+ * branch vertices above a and are at most k - 1 edges long are enumerated with
+ * their length as budget; a branch vertex whose shortest way back to a does
+ * not fit the remaining budget is not entered. Two paths to the same branch vertex whose lengths
+ * sum to k and whose interiors are disjoint are joined into a cycle, which is
+ * expanded back to the vertices of the graph. Only the paths of one anchor are
+ * held at a time.
+ *
+ * @param g             The undirected graph; left unchanged.
+ * @param k             Length of the cycles.
+ * @param verbose       If non-zero, prints the size of the contracted graph.
+ * @param path_count    Receives the number of contracted paths enumerated.
+ * @param cycle_count   Receives the number of cycles found.
+ * @param cycles        Receives the hash set of canonical cycles, in graph ids.
+ * @return              1 on success, 0 on allocation failure.
+ */
+int find_chain_cycles(const Graph *g, int k, int verbose, int *path_count, int *cycle_count, CycleSetEntry **cycles);
+
+#endif // CHAINS_H
@@ -0,0 +1,330 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Marco Blok
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// components.c
+#include "components.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Tarjan's algorithm. A vertex is on the component stack while it has an
+// index but no component yet; frames of the depth-first search keep the
+// vertex and the next arc to follow.
+int strong_components(const Graph *g, int *component) {
+    int n = g->n;
+    int *index = malloc((n ? n : 1) * sizeof(int));
+    int *low = malloc((n ? n : 1) * sizeof(int));
+    int *stack = malloc((n ? n : 1) * sizeof(int));
+    int *frames = malloc((n ? n : 1) * sizeof(int));
+    size_t *cursor = malloc((n ? n : 1) * sizeof(size_t));
+    if (!index || !low || !stack || !frames || !cursor) {
+        free(index);
+        free(low);
+        free(stack);
+        free(frames);
+        free(cursor);
+        return -1;
+    }
+
+    for (int v = 0; v < n; v++) {
+        index[v] = -1;
+        component[v] = -1;
+    }
+
+    int next_index = 0, count = 0, sp = 0;
+    for (int root = 0; root < n; root++) {
+        if (index[root] >= 0) continue;
+
+        int top = 0;
+        index[root] = low[root] = next_index++;
+        stack[sp++] = root;
+        frames[top] = root;
+        cursor[top++] = g->offsets[root];
+
+        while (top > 0) {
+            int v = frames[top - 1];
+            if (cursor[top - 1] < g->offsets[v + 1]) {
+                int w = g->neighbors[cursor[top - 1]++];
+                if (index[w] < 0) {
+                    // Descend into w
+                    index[w] = low[w] = next_index++;
+                    stack[sp++] = w;
+                    frames[top] = w;
+                    cursor[top++] = g->offsets[w];
+                } else if (component[w] < 0 && index[w] < low[v]) {
+                    low[v] = index[w];
+                }
+                continue;
+            }
+
+            // All arcs of v are done; v roots a component if nothing below reached higher
+            top--;
+            if (low[v] == index[v]) {
+                int w;
+                do {
+                    w = stack[--sp];
+                    component[w] = count;
+                } while (w != v);
+                count++;
+            }
+            if (top > 0 && low[v] < low[frames[top - 1]]) low[frames[top - 1]] = low[v];
+        }
+    }
+
+    free(index);
+    free(low);
+    free(stack);
+    free(frames);
+    free(cursor);
+    return count;
+}
+
+static int compare_keys(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Counting sort of the vertices by component, skipping small components.
+int group_components(const int *component, int n, int count, int min_size, Components *out) {
+    int *size = calloc(count ? count : 1, sizeof(int));
+    int *slot = malloc((count ? count : 1) * sizeof(int));
+    uint64_t *keys = malloc((count ? count : 1) * sizeof(uint64_t));
+    if (!size || !slot || !keys) {
+        free(size);
+        free(slot);
+        free(keys);
+        return 0;
+    }
+    for (int v = 0; v < n; v++) size[component[v]]++;
+
+    // Number the kept components by decreasing size, ties by component
+    int kept = 0, total = 0;
+    for (int c = 0; c < count; c++) {
+        slot[c] = -1;
+        if (size[c] < min_size) continue;
+        keys[kept++] = ((uint64_t)(n - size[c]) << 32) | (uint32_t)c;
+        total += size[c];
+    }
+    qsort(keys, kept, sizeof(uint64_t), compare_keys);
+
+    out->count = kept;
+    out->offsets = malloc((kept + 1) * sizeof(int));
+    out->vertices = malloc((total ? total : 1) * sizeof(int));
+    if (!out->offsets || !out->vertices) {
+        free_components(out);
+        free(size);
+        free(slot);
+        free(keys);
+        return 0;
+    }
+
+    // slot[c] becomes the write position of component c
+    out->offsets[0] = 0;
+    for (int i = 0; i < kept; i++) {
+        int c = (int)(uint32_t)keys[i];
+        slot[c] = out->offsets[i];
+        out->offsets[i + 1] = out->offsets[i] + size[c];
+    }
+    for (int v = 0; v < n; v++) {
+        int c = component[v];
+        if (slot[c] >= 0) out->vertices[slot[c]++] = v;
+    }
+
+    free(size);
+    free(slot);
+    free(keys);
+    return 1;
+}
+
+static int compare_ints(const void *a, const void *b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Growable Components under construction
+typedef struct {
+    Components c;
+    int capacity;           // Capacity of c.offsets minus one
+    size_t vertex_capacity; // Capacity of c.vertices
+} BlockList;
+
+// Pops the edges of one block off the edge stack, down to and including the
+// tree edge (u, v), and records its vertices unless the block is too small.
+static int close_block(BlockList *b, Edge *edges, size_t *sp, int u, int v,
+                       int *mark, int stamp, int min_size) {
+    size_t begin = b->c.offsets[b->c.count], end = begin;
+    Edge e;
+    do {
+        e = edges[--(*sp)];
+        int ends[2] = {e.u, e.v};
+        for (int i = 0; i < 2; i++) {
+            if (mark[ends[i]] == stamp) continue;
+            mark[ends[i]] = stamp;
+            if (end == b->vertex_capacity) {
+                size_t capacity = 2 * b->vertex_capacity;
+                int *grown = realloc(b->c.vertices, capacity * sizeof(int));
+                if (!grown) return 0;
+                b->c.vertices = grown;
+                b->vertex_capacity = capacity;
+            }
+            b->c.vertices[end++] = ends[i];
+        }
+    } while (e.u != u || e.v != v);
+
+    if ((int)(end - begin) < min_size) return 1;
+    if (b->c.count == b->capacity) {
+        int capacity = 2 * b->capacity;
+        int *grown = realloc(b->c.offsets, (capacity + 1) * sizeof(int));
+        if (!grown) return 0;
+        b->c.offsets = grown;
+        b->capacity = capacity;
+    }
+    qsort(b->c.vertices + begin, end - begin, sizeof(int), compare_ints);
+    b->c.offsets[++b->c.count] = (int)end;
+    return 1;
+}
+
+// Renumbers the components by decreasing size.
+static int order_by_size(Components *c) {
+    uint64_t *keys = malloc((c->count ? c->count : 1) * sizeof(uint64_t));
+    int *offsets = malloc((c->count + 1) * sizeof(int));
+    int *vertices = malloc((c->offsets[c->count] ? c->offsets[c->count] : 1) * sizeof(int));
+    if (!keys || !offsets || !vertices) {
+        free(keys);
+        free(offsets);
+        free(vertices);
+        return 0;
+    }
+
+    for (int i = 0; i < c->count; i++) {
+        uint32_t size = (uint32_t)(c->offsets[i + 1] - c->offsets[i]);
+        keys[i] = ((uint64_t)(UINT32_MAX - size) << 32) | (uint32_t)i;
+    }
+    qsort(keys, c->count, sizeof(uint64_t), compare_keys);
+
+    offsets[0] = 0;
+    for (int i = 0; i < c->count; i++) {
+        int id = (int)(uint32_t)keys[i];
+        int size = c->offsets[id + 1] - c->offsets[id];
+        memcpy(vertices + offsets[i], c->vertices + c->offsets[id], size * sizeof(int));
+        offsets[i + 1] = offsets[i] + size;
+    }
+
+    free(keys);
+    free(c->offsets);
+    free(c->vertices);
+    c->offsets = offsets;
+    c->vertices = vertices;
+    return 1;
+}
+
+// Hopcroft-Tarjan. Tree and back edges are stacked as they are first seen;
+// when the subtree of a tree edge (u, v) cannot reach above u, the edges
+// stacked since (u, v) form one block.
+int biconnected_components(const Graph *g, int min_size, Components *out) {
+    int n = g->n;
+    BlockList b = {{0, NULL, NULL}, 16, (size_t)(n ? n : 1)};
+    b.c.offsets = malloc((b.capacity + 1) * sizeof(int));
+    b.c.vertices = malloc(b.vertex_capacity * sizeof(int));
+    int *disc = malloc((n ? n : 1) * sizeof(int));
+    int *low = malloc((n ? n : 1) * sizeof(int));
+    int *frames = malloc((n ? n : 1) * sizeof(int));
+    int *parent = malloc((n ? n : 1) * sizeof(int));
+    size_t *cursor = malloc((n ? n : 1) * sizeof(size_t));
+    int *mark = malloc((n ? n : 1) * sizeof(int));
+    Edge *edges = malloc((g->m / 2 + 1) * sizeof(Edge));
+    int ok = b.c.offsets && b.c.vertices && disc && low && frames && parent && cursor && mark && edges;
+
+    if (ok) {
+        b.c.offsets[0] = 0;
+        for (int v = 0; v < n; v++) {
+            disc[v] = -1;
+            mark[v] = -1;
+        }
+    }
+
+    int next_disc = 0, stamp = 0;
+    size_t sp = 0;
+    for (int root = 0; ok && root < n; root++) {
+        if (disc[root] >= 0 || g->offsets[root] == g->offsets[root + 1]) continue;
+
+        int top = 0;
+        disc[root] = low[root] = next_disc++;
+        parent[root] = -1;
+        frames[top] = root;
+        cursor[top++] = g->offsets[root];
+
+        while (ok && top > 0) {
+            int v = frames[top - 1];
+            if (cursor[top - 1] < g->offsets[v + 1]) {
+                int w = g->neighbors[cursor[top - 1]++];
+                if (disc[w] < 0) {
+                    // Tree edge: descend into w
+                    edges[sp++] = (Edge){v, w};
+                    disc[w] = low[w] = next_disc++;
+                    parent[w] = v;
+                    frames[top] = w;
+                    cursor[top++] = g->offsets[w];
+                } else if (w != parent[v] && disc[w] < disc[v]) {
+                    // Back edge to an ancestor
+                    edges[sp++] = (Edge){v, w};
+                    if (disc[w] < low[v]) low[v] = disc[w];
+                }
+                continue;
+            }
+
+            // All edges of v are done; close the block of the tree edge into v
+            top--;
+            if (top == 0) break;
+            int u = frames[top - 1];
+            if (low[v] < low[u]) low[u] = low[v];
+            if (low[v] >= disc[u]) {
+                ok = close_block(&b, edges, &sp, u, v, mark, stamp++, min_size);
+            }
+        }
+    }
+
+    free(disc);
+    free(low);
+    free(frames);
+    free(parent);
+    free(cursor);
+    free(mark);
+    free(edges);
+    if (ok) ok = order_by_size(&b.c);
+    if (!ok) {
+        free_components(&b.c);
+        return 0;
+    }
+    *out = b.c;
+    return 1;
+}
+
+// Frees the grouped vertices.
+void free_components(Components *c) {
+    free(c->offsets);
+    free(c->vertices);
+    c->offsets = NULL;
+    c->vertices = NULL;
+    c->count = 0;
+}
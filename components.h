@@ -0,0 +1,90 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Marco Blok
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// components.h
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include "graph.h"
+
+/**
+ * @brief Vertices grouped by the component they belong to.
+ *
+ * The vertices of component c are vertices[offsets[c] .. offsets[c + 1]),
+ * in increasing order. Components are numbered by decreasing size. A vertex
+ * may belong to several biconnected components.
+ */
+typedef struct {
+    int count;          // Number of components
+    int *offsets;       // count + 1 offsets into vertices
+    int *vertices;      // Vertices grouped by component
+} Components;
+
+/**
+ * @brief Computes the strongly connected components of a directed graph.
+ *
+ * Uses Tarjan's algorithm with an explicit stack, so deep graphs cannot
+ * overflow the call stack. Every directed cycle lies within one component.
+ * Components are numbered in reverse topological order of the condensation.
+ *
+ * @param g             The graph; its out-rows are followed (not GRAPH_COMPRESSED).
+ * @param component     Output array of g->n entries receiving the component of every vertex.
+ * @return              Number of components, or -1 on allocation failure.
+ */
+int strong_components(const Graph *g, int *component);
+
+/**
+ * @brief Groups the vertices by component, dropping components that are too small.
+ *
+ * @param component     Component of every vertex, as returned by strong_components().
+ * @param n             Number of vertices.
+ * @param count         Number of components.
+ * @param min_size      Components with fewer vertices are left out.
+ * @param out           Receives the grouped vertices; release with free_components().
+ * @return              1 on success, 0 on allocation failure.
+ */
+int group_components(const int *component, int n, int count, int min_size, Components *out);
+
+/**
+ * @brief Computes the biconnected components (blocks) of an undirected graph.
+ *
+ * Uses the Hopcroft-Tarjan algorithm with an explicit stack of edges. Every
+ * simple cycle lies within one block, and two blocks share at most one
+ * (articulation) vertex. Vertices without edges belong to no block.
+ *
+ * @param g             The graph; its rows are followed (not GRAPH_COMPRESSED).
+ * @param min_size      Blocks with fewer vertices are left out.
+ * @param out           Receives the blocks; release with free_components().
+ * @return              1 on success, 0 on allocation failure.
+ */
+int biconnected_components(const Graph *g, int min_size, Components *out);
+
+/**
+ * @brief Frees the arrays of a Components structure.
+ *
+ * @param c             Components to free.
+ */
+void free_components(Components *c);
+
+#endif // COMPONENTS_H
\ No newline at end of file
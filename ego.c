@@ -0,0 +1,191 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Marco Blok
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// ego.c
+#include "ego.h"
+#include "parallel.h"
+#include <stdlib.h>
+
+// Cycles and path counts of one thread
+typedef struct {
+    int paths[2];
+    int cycle_count;
+    CycleSetEntry *cycles;
+    int ok;
+} EgoResult;
+
+// Shared state of the threads
+typedef struct {
+    const Graph *g;
+    int l1, l2;
+    EgoResult *results;
+} EgoRun;
+
+static int compare_ints(const void *a, const void *b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Collects the vertices above the anchor within radius edges of it, over the
+// arcs in both directions, into queue. Returns their number, anchor included.
+static int ego_vertices(const Graph *g, int anchor, int radius, int *queue, int *dist, int *seen, int stamp) {
+    int head = 0, tail = 0;
+    seen[anchor] = stamp;
+    dist[anchor] = 0;
+    queue[tail++] = anchor;
+    while (head < tail) {
+        int x = queue[head++];
+        if (dist[x] == radius) break;
+        for (int dir = 0; dir < (g->directed ? 2 : 1); dir++) {
+            if (g->backend == GRAPH_COMPRESSED) {
+                PackedRow row = graph_packed_row(g, x, dir);
+                int w;
+                while (packed_row_next(&row, &w)) {
+                    if (w <= anchor || seen[w] == stamp) continue;
+                    seen[w] = stamp;
+                    dist[w] = dist[x] + 1;
+                    queue[tail++] = w;
+                }
+                continue;
+            }
+
+            const size_t *offsets = dir ? g->in_offsets : g->offsets;
+            const int *neighbors = dir ? g->in_neighbors : g->neighbors;
+            for (size_t e = offsets[x]; e < offsets[x + 1]; e++) {
+                int w = neighbors[e];
+                if (w <= anchor || seen[w] == stamp) continue;
+                seen[w] = stamp;
+                dist[w] = dist[x] + 1;
+                queue[tail++] = w;
+            }
+        }
+    }
+    return tail;
+}
+
+// Joins the paths through vertex 0 of the ego network. Paths back to 0 are
+// searched from 0 on the transposed rows and reversed. Returns 0 on
+// allocation failure.
+static int ego_join(const Graph *sub, PathSearch *search, int l1, int l2, int *paths,
+                    CycleSetEntry **found) {
+    int c1 = 0, c2 = 0;
+    PathMap *out = path_map_new(l1), *back = path_map_new(l2);
+    int ok = out && back && add_paths_from(sub, search, 0, -1, out, &c1);
+    if (ok && sub->directed) {
+        Graph t = graph_transposed(sub);
+        ok = add_paths_from(&t, search, 0, -1, back, &c2);
+    } else if (ok) {
+        ok = add_paths_from(sub, search, 0, -1, back, &c2);
+    }
+
+    *found = NULL;
+    if (ok) {
+        reverse_path_map(back);
+        int count;
+        JoinMode mode = sub->directed ? JOIN_ANCHORED_DIRECTED : JOIN_ANCHORED;
+        *found = path_join(out, l1, back, l2, sub->n, mode, &count, 0);
+    }
+    free_path_map(out);
+    free_path_map(back);
+
+    paths[0] += c1;
+    paths[l1 == l2 ? 0 : 1] += c2;
+    return ok;
+}
+
+// Extracts and searches the ego network of every anchor of this thread.
+static void ego_task(void *ctx, int thread, int threads) {
+    EgoRun *run = ctx;
+    const Graph *g = run->g;
+    EgoResult *res = &run->results[thread];
+    int n = g->n, k = run->l1 + run->l2;
+
+    int *queue = malloc((n ? n : 1) * sizeof(int));
+    int *dist = malloc((n ? n : 1) * sizeof(int));
+    int *seen = calloc(n ? n : 1, sizeof(int));
+    int *rank = malloc((n ? n : 1) * sizeof(int));
+    // Ego networks have at most n vertices
+    PathSearch *search = path_search_new(n, k);
+    if (!queue || !dist || !seen || !rank || !search) {
+        free(queue);
+        free(dist);
+        free(seen);
+        free(rank);
+        path_search_free(search);
+        return;
+    }
+    for (int v = 0; v < n; v++) rank[v] = -1;
+
+    res->ok = 1;
+    int stamp = 0;
+    for (int anchor = thread; anchor < n; anchor += threads) {
+        if (g->degrees[anchor] == 0) continue;
+        int count = ego_vertices(g, anchor, k / 2, queue, dist, seen, ++stamp);
+        if (count < k) continue;
+
+        // Increasing ids keep the anchor at 0 and the rows sorted
+        qsort(queue, count, sizeof(int), compare_ints);
+        Graph *sub = graph_subgraph(g, queue, count, rank);
+        if (!sub) {
+            res->ok = 0;
+            continue;
+        }
+
+        CycleSetEntry *found;
+        if (!ego_join(sub, search, run->l1, run->l2, res->paths, &found)) res->ok = 0;
+        found = relabel_cycles(found, sub->orig_id);
+        res->cycle_count += append_cycles(&res->cycles, found);
+        graph_free(sub);
+    }
+
+    free(queue);
+    free(dist);
+    free(seen);
+    free(rank);
+    path_search_free(search);
+}
+
+// Runs the anchors on the threads and merges their cycle sets.
+int find_ego_cycles(const Graph *g, int l1, int l2, int threads,
+                    int *path_counts, int *cycle_count, CycleSetEntry **cycles) {
+    if (threads > g->n) threads = g->n > 0 ? g->n : 1;
+    EgoResult *results = calloc(threads, sizeof(EgoResult));
+    if (!results) return 0;
+
+    EgoRun run = {g, l1, l2, results};
+    parallel_run(threads, ego_task, &run);
+
+    int ok = 1;
+    *cycle_count = 0;
+    *cycles = NULL;
+    for (int t = 0; t < threads; t++) {
+        ok &= results[t].ok;
+        path_counts[0] += results[t].paths[0];
+        if (l1 != l2) path_counts[1] += results[t].paths[1];
+        *cycle_count += append_cycles(cycles, results[t].cycles);
+    }
+
+    free(results);
+    return ok;
+}
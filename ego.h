@@ -0,0 +1,56 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Marco Blok
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// ego.h
+#ifndef EGO_H
+#define EGO_H
+
+#include "graph.h"
+#include "pathjoin.h"
+
+/**
+ * @brief Enumerates the cycles of length l1 + l2 one anchor vertex at a time.
+ *
+ * Every cycle is found at its lowest vertex v, the anchor. All of its vertices
+ * are at least v and lie within (l1 + l2) / 2 edges of v in the subgraph of
+ * those vertices (ignoring arc directions), so that ego network is extracted
+ * with graph_subgraph() into a small graph of its own, in which v becomes
+ * vertex 0. The paths of length l1 from 0 and of length l2 back to 0 are
+ * enumerated and joined there, and the cycles found are mapped to input ids.
+ * Threads take the anchors round-robin and merge their cycles at the end.
+ *
+ * @param g             The graph, on any backend.
+ * @param l1            Length of the paths leaving the anchor.
+ * @param l2            Length of the paths returning to it.
+ * @param threads       Number of threads to use.
+ * @param path_counts   Receives the number of paths of length l1 and of length l2
+ *                      (both in path_counts[0] if l1 == l2).
+ * @param cycle_count   Receives the number of cycles found.
+ * @param cycles        Receives the hash set of canonical cycles, in input ids.
+ * @return              1 on success, 0 on allocation failure.
+ */
+int find_ego_cycles(const Graph *g, int l1, int l2, int threads,
+                    int *path_counts, int *cycle_count, CycleSetEntry **cycles);
+
+#endif // EGO_H
@@ -0,0 +1,297 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Marco Blok
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// estimate.c
+#include "estimate.h"
+#include <stdlib.h>
+
+#include "paths.h"
+#include "pathjoin.h"
+
+// Rough single-core costs measured on the bundled graphs: one neighbor visit
+// and one stored path in get_paths(), one map entry scanned in the 3- and
+// 4-joins, and one joined closed walk (validation, canonical form and cycle
+// set lookup)
+#define SECONDS_PER_STEP 4e-9
+#define SECONDS_PER_PATH 120e-9
+#define SECONDS_PER_SCAN 20e-9
+#define SECONDS_PER_CLOSED_WALK 1e-6
+
+// Memory not modelled per path or cycle: allocator slack and hash table growth
+#define MEMORY_SLACK 1.15
+
+// Bytes glibc's malloc uses for a request of the given size.
+static double chunk_bytes(size_t request) {
+    size_t chunk = (request + 8 + 15) & ~(size_t)15;
+    return chunk < 32 ? 32 : (double)chunk;
+}
+
+// xorshift64* generator; estimates are reproducible across runs.
+static uint64_t next_random(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+// Uniform double in [0, 1).
+static double random_unit(uint64_t *state) {
+    return (double)(next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Square root by Newton's method, so the build does not need libm.
+static double square_root(double x) {
+    if (x <= 0) return 0;
+    double r = x > 1 ? x : 1;
+    for (int i = 0; i < 64; i++) {
+        double next = 0.5 * (r + x / r);
+        if (next >= r) break;
+        r = next;
+    }
+    return r;
+}
+
+// Every this many probes also measure how many vertices lie near their start
+#define KEY_PROBE_STRIDE 64
+
+// Counts the vertices other than start within distance d of it, for every
+// d <= max_len, into ball[d]. Gives up once more than limit vertices were
+// found; ball[d] is then limit + 1 for the depths not completed.
+static void count_ball(const Graph *g, int start, int max_len, double limit,
+                       int *queue, int *stamp, int mark, double *ball) {
+    int head = 0, tail = 0;
+    queue[tail++] = start;
+    stamp[start] = mark;
+
+    for (int d = 1; d <= max_len; d++) {
+        int layer_end = tail;
+        while (head < layer_end && tail - 1 <= limit) {
+            int u = queue[head++];
+            for (size_t e = g->offsets[u]; e < g->offsets[u + 1]; e++) {
+                int v = g->neighbors[e];
+                if (stamp[v] != mark) {
+                    stamp[v] = mark;
+                    queue[tail++] = v;
+                }
+            }
+        }
+        if (tail - 1 > limit) {
+            for (; d <= max_len; d++) ball[d] = limit + 1;
+            return;
+        }
+        ball[d] = tail - 1;
+    }
+}
+
+// Sums over all probes for one length.
+typedef struct {
+    double sum;
+    double sum_sq;
+    double keys;        // Over every KEY_PROBE_STRIDE-th probe only
+    double steps;       // Neighbor visits at this depth
+} ProbeSums;
+
+// Turns the probe sums into an estimate of the total over all vertices.
+static CountEstimate finish_estimate(const ProbeSums *s, double population, int samples) {
+    double mean = s->sum / samples;
+    double var = s->sum_sq / samples - mean * mean;
+    int key_probes = (samples + KEY_PROBE_STRIDE - 1) / KEY_PROBE_STRIDE;
+    CountEstimate est = {0};
+    est.count = population * mean;
+    est.error = population * square_root(var > 0 ? var / samples : 0);
+    est.keys = population * s->keys / key_probes;
+    if (est.keys > est.count) est.keys = est.count;
+    return est;
+}
+
+// Every cycle is found once per start vertex, and in undirected graphs once
+// per direction; 2-cycles of undirected graphs are single edges.
+static int cycle_repeats(const Graph *g, int cyclesize) {
+    return g->directed || cyclesize == 2 ? cyclesize : 2 * cyclesize;
+}
+
+// Runs Knuth-style random probes down the path DFS tree.
+int estimate_counts(const Graph *g, int max_len, int cyclesize, int samples,
+                    CountEstimate *paths, CountEstimate *cycles) {
+    int probe_len = max_len > cyclesize - 1 ? max_len : cyclesize - 1;
+    int *active = malloc((g->n ? g->n : 1) * sizeof(int));
+    int *queue = malloc((g->n ? g->n : 1) * sizeof(int));
+    int *stamp = calloc(g->n ? g->n : 1, sizeof(int));
+    int *path = malloc((probe_len + 1) * sizeof(int));
+    double *weights = malloc((probe_len + 1) * sizeof(double));
+    double *ball = malloc((probe_len + 1) * sizeof(double));
+    ProbeSums *sums = calloc(probe_len + 1, sizeof(ProbeSums));
+    if (!active || !queue || !stamp || !path || !weights || !ball || !sums) {
+        free(active);
+        free(queue);
+        free(stamp);
+        free(path);
+        free(weights);
+        free(ball);
+        free(sums);
+        return 0;
+    }
+
+    int population = 0;
+    for (int v = 0; v < g->n; v++) {
+        if (g->degrees[v] > 0) active[population++] = v;
+    }
+
+    ProbeSums closed = {0};
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (int j = 0; population > 0 && j < samples; j++) {
+        // One start per even stratum of the vertices keeps the variance low
+        size_t pick = (size_t)((j + random_unit(&state)) * population / samples);
+        int start = active[pick < (size_t)population ? pick : (size_t)population - 1];
+        double weight = 1;
+        int depth = 0;
+        path[0] = start;
+
+        for (int d = 0; d < probe_len; d++) {
+            int u = path[d];
+            size_t begin = g->offsets[u], end = g->offsets[u + 1];
+            sums[d].steps += weight * (double)(end - begin);
+
+            // Count the neighbors that are not yet on the path
+            int choices = 0;
+            for (size_t e = begin; e < end; e++) {
+                int v = g->neighbors[e], on_path = 0;
+                for (int i = 0; i <= d && !on_path; i++) on_path = path[i] == v;
+                choices += !on_path;
+            }
+            if (choices == 0) break;
+
+            // Move to a uniformly chosen one of them
+            int r = (int)(random_unit(&state) * choices);
+            for (size_t e = begin; e < end; e++) {
+                int v = g->neighbors[e], on_path = 0;
+                for (int i = 0; i <= d && !on_path; i++) on_path = path[i] == v;
+                if (!on_path && r-- == 0) {
+                    path[d + 1] = v;
+                    break;
+                }
+            }
+
+            weight *= choices;
+            weights[++depth] = weight;
+            sums[d + 1].sum += weight;
+            sums[d + 1].sum_sq += weight * weight;
+
+            if (d + 1 == cyclesize - 1 && graph_has_edge(g, path[d + 1], start)) {
+                closed.sum += weight;
+                closed.sum_sq += weight * weight;
+            }
+        }
+
+        // A path map key is a (start, end) pair, so the paths of a start have
+        // at most as many keys as there are vertices within reach
+        if (j % KEY_PROBE_STRIDE == 0 && depth > 0) {
+            count_ball(g, start, depth, weights[depth], queue, stamp, j / KEY_PROBE_STRIDE + 1, ball);
+            for (int d = 1; d <= depth; d++) {
+                sums[d].keys += weights[d] < ball[d] ? weights[d] : ball[d];
+            }
+        }
+    }
+
+    double steps = 0;
+    for (int len = 0; len <= max_len; len++) {
+        paths[len] = finish_estimate(&sums[len], population, samples);
+        paths[len].steps = population * steps / samples;
+        steps += sums[len].steps;
+    }
+    paths[0].count = population;
+    paths[0].error = 0;
+
+    int repeats = cycle_repeats(g, cyclesize);
+    *cycles = finish_estimate(&closed, population, samples);
+    cycles->count /= repeats;
+    cycles->error /= repeats;
+    cycles->keys = 0;
+
+    free(active);
+    free(queue);
+    free(stamp);
+    free(path);
+    free(weights);
+    free(ball);
+    free(sums);
+    return 1;
+}
+
+// Path vertices in the arena, whose last chunk is on average a quarter
+// empty, and per key an entry in the doubling entry array and on average
+// three slots of the key table.
+double path_map_bytes(const CountEstimate *est, int len) {
+    double per_path = 1.25 * (len + 1) * sizeof(int);
+    double per_key = 1.5 * sizeof(PathMapEntry) + 3 * (sizeof(uint64_t) + sizeof(int));
+    return MEMORY_SLACK * (est->count * per_path + est->keys * per_key);
+}
+
+// Canonical cycle copies and one set entry per cycle.
+double cycle_set_bytes(const CountEstimate *est, int cyclesize) {
+    double per_cycle = chunk_bytes(sizeof(CycleSetEntry)) + chunk_bytes((cyclesize + 1) * sizeof(int)) + 16;
+    return MEMORY_SLACK * est->count * per_cycle;
+}
+
+// Neighbor visits plus path copies and hash inserts.
+double path_seconds(const CountEstimate *est) {
+    return est->steps * SECONDS_PER_STEP + est->count * SECONDS_PER_PATH;
+}
+
+// The 2-join looks every key up directly; the 3- and 4-joins scan the keys of
+// the second (and third) map that start where a key of the previous one ends,
+// on average keys / n of them. Every closed walk that is found is then
+// validated and canonicalized.
+double join_seconds(const Graph *g, const int *config, int config_len,
+                    const CountEstimate *paths, const CountEstimate *cycles, int cyclesize) {
+    double scans = 0;
+    if (config_len >= 3 && g->n > 0) {
+        double keys1 = paths[config[0]].keys, keys2 = paths[config[1]].keys;
+        scans = keys1 * (keys2 / g->n);
+        if (config_len == 4) scans *= 1 + paths[config[2]].keys / g->n;
+    }
+    double closed = cycles->count * cycle_repeats(g, cyclesize);
+    return scans * SECONDS_PER_SCAN + closed * SECONDS_PER_CLOSED_WALK;
+}
+
+// Parses a number with an optional K/M/G/T suffix; plain numbers are MiB.
+int parse_memory_size(const char *text, double *bytes) {
+    char *end;
+    double value = strtod(text, &end);
+    if (end == text || !(value > 0)) return 0;
+
+    double unit = 1024.0 * 1024.0;
+    if (*end) {
+        switch (*end) {
+            case 'k': case 'K': unit = 1024.0; break;
+            case 'm': case 'M': unit = 1024.0 * 1024.0; break;
+            case 'g': case 'G': unit = 1024.0 * 1024.0 * 1024.0; break;
+            case 't': case 'T': unit = 1024.0 * 1024.0 * 1024.0 * 1024.0; break;
+            default: return 0;
+        }
+        if (end[1] != '\0' && !((end[1] == 'B' || end[1] == 'b') && end[2] == '\0')) return 0;
+    }
+    *bytes = value * unit;
+    return 1;
+}
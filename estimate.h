@@ -0,0 +1,119 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Marco Blok
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// estimate.h
+#ifndef ESTIMATE_H
+#define ESTIMATE_H
+
+#include "graph.h"
+
+// Number of random probes used by estimate_counts()
+#define ESTIMATE_SAMPLES 100000
+
+/**
+ * @brief Estimated number of simple paths (or cycles) of one length.
+ */
+typedef struct {
+    double count;       // Estimated number of paths, or of cycles
+    double error;       // Standard error of count
+    double keys;        // Estimated number of distinct (start, end) pairs, at most count (paths only)
+    double steps;       // Estimated neighbor visits of the DFS enumerating them (paths only)
+} CountEstimate;
+
+/**
+ * @brief Estimates the number of simple paths of every length up to max_len
+ *        and the number of simple cycles of length cyclesize.
+ *
+ * Uses Knuth's estimator of backtracking tree sizes: every probe starts at a
+ * vertex drawn from an even stratum of all vertices with arcs and repeatedly
+ * moves to a uniformly chosen out-neighbor that is not yet on the path. The
+ * product of the number of choices along the probe is an unbiased estimate of
+ * the paths from its start, so no path is ever stored. A path of length
+ * cyclesize - 1 whose last vertex has an arc back to its start closes a cycle.
+ * The CSR neighbor arrays are used, so this must run before switching to the
+ * compressed backend.
+ *
+ * @param g         The graph.
+ * @param max_len   Longest path length to estimate.
+ * @param cyclesize Cycle length to estimate (at least 2).
+ * @param samples   Number of probes.
+ * @param paths     Output array of max_len + 1 entries; entry l estimates paths of length l.
+ * @param cycles    Output parameter that receives the cycle estimate.
+ * @return          1 on success, 0 on allocation failure.
+ */
+int estimate_counts(const Graph *g, int max_len, int cyclesize, int samples,
+                    CountEstimate *paths, CountEstimate *cycles);
+
+/**
+ * @brief Estimates the heap memory of a path map as built by get_paths().
+ *
+ * @param est       Estimate for the path length.
+ * @param len       Path length.
+ * @return          Estimated number of bytes.
+ */
+double path_map_bytes(const CountEstimate *est, int len);
+
+/**
+ * @brief Estimates the heap memory of the cycle set built by the path join.
+ *
+ * @param est       Cycle estimate.
+ * @param cyclesize Cycle length.
+ * @return          Estimated number of bytes.
+ */
+double cycle_set_bytes(const CountEstimate *est, int cyclesize);
+
+/**
+ * @brief Estimates the time get_paths() takes, in seconds.
+ *
+ * @param est       Estimate for the path length.
+ * @return          Estimated seconds on a single core.
+ */
+double path_seconds(const CountEstimate *est);
+
+/**
+ * @brief Estimates the time the path join takes, in seconds.
+ *
+ * @param g         The graph.
+ * @param config    Path lengths of the join.
+ * @param config_len Number of joined paths (2 to 4).
+ * @param paths     Path estimates indexed by length, covering every length in config.
+ * @param cycles    Cycle estimate.
+ * @param cyclesize Cycle length.
+ * @return          Estimated seconds on a single core.
+ */
+double join_seconds(const Graph *g, const int *config, int config_len,
+                    const CountEstimate *paths, const CountEstimate *cycles, int cyclesize);
+
+/**
+ * @brief Parses a memory size such as "512", "800M" or "16G".
+ *
+ * A number without suffix is taken as MiB; K, M, G and T select KiB to TiB.
+ *
+ * @param text      Text to parse.
+ * @param bytes     Output parameter that receives the size in bytes.
+ * @return          1 on success, 0 if the text is not a positive size.
+ */
+int parse_memory_size(const char *text, double *bytes);
+
+#endif // ESTIMATE_H
\ No newline at end of file
@@ -0,0 +1,745 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Marco Blok
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// graph.c
+#include "graph.h"
+#include "parallel.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+// Shared state of the parallel CSR construction
+typedef struct {
+    int n;
+    const EdgeList *lists;
+    int nlists;
+    size_t edges;           // Number of edges over all lists
+    int reverse;            // Bucket arcs by target instead of source
+    int symmetric;          // Store every edge in both directions
+    size_t *counts;         // threads x n arcs per thread and row, then scatter positions
+    size_t *offsets;
+    int *neighbors;
+    size_t *lengths;        // Row lengths after removing duplicates
+    int *bounds;            // Vertex range of each thread
+    int *degrees;           // Receives the row lengths, added to the existing counts
+} RowBuilder;
+
+// Counts (pass 0) or scatters (pass 1) the arcs of this thread's slice of the
+// edges into its own row cursors. Slices follow the input order and every
+// thread owns a separate block of each row, so rows are filled in input order
+// without atomics. Self-loops are dropped here.
+static void bucket_slice(RowBuilder *b, int thread, int threads, int pass) {
+    size_t *cursor = b->counts + (size_t)thread * b->n;
+    size_t skip = parallel_slice(b->edges, thread, threads);
+    size_t todo = parallel_slice(b->edges, thread + 1, threads) - skip;
+
+    for (int l = 0; l < b->nlists && todo > 0; l++) {
+        size_t count = b->lists[l].count;
+        if (skip >= count) {
+            skip -= count;
+            continue;
+        }
+        const Edge *edges = b->lists[l].edges + skip;
+        size_t take = count - skip < todo ? count - skip : todo;
+        skip = 0;
+        todo -= take;
+
+        for (size_t i = 0; i < take; i++) {
+            int u = edges[i].u;
+            int v = edges[i].v;
+            if (u == v) continue; // skip self-loops
+            if (b->reverse) {
+                int tmp = u;
+                u = v;
+                v = tmp;
+            }
+
+            if (pass == 0) {
+                cursor[u]++;
+                if (b->symmetric) cursor[v]++;
+            } else {
+                b->neighbors[cursor[u]++] = v;
+                if (b->symmetric) b->neighbors[cursor[v]++] = u;
+            }
+        }
+    }
+}
+
+static void count_task(void *ctx, int thread, int threads) {
+    bucket_slice(ctx, thread, threads, 0);
+}
+
+static void scatter_task(void *ctx, int thread, int threads) {
+    bucket_slice(ctx, thread, threads, 1);
+}
+
+// Sums the per-thread counts of the rows in this thread's vertex range into
+// the row lengths, stored one slot ahead in offsets.
+static void total_task(void *ctx, int thread, int threads) {
+    RowBuilder *b = ctx;
+    for (int u = b->bounds[thread]; u < b->bounds[thread + 1]; u++) {
+        size_t total = 0;
+        for (int t = 0; t < threads; t++) total += b->counts[(size_t)t * b->n + u];
+        b->offsets[u + 1] = total;
+    }
+}
+
+// Turns the per-thread counts of the rows in this thread's vertex range into
+// the write position of every thread's block within the row.
+static void cursor_task(void *ctx, int thread, int threads) {
+    RowBuilder *b = ctx;
+    for (int u = b->bounds[thread]; u < b->bounds[thread + 1]; u++) {
+        size_t position = b->offsets[u];
+        for (int t = 0; t < threads; t++) {
+            size_t *count = &b->counts[(size_t)t * b->n + u];
+            size_t arcs = *count;
+            *count = position;
+            position += arcs;
+        }
+    }
+}
+
+// Splits the vertices into ranges holding roughly equal numbers of arcs.
+static void balance_bounds(RowBuilder *b, int threads) {
+    size_t arcs = b->offsets[b->n];
+    b->bounds[0] = 0;
+    for (int t = 1; t < threads; t++) {
+        size_t target = parallel_slice(arcs, t, threads);
+        int lo = b->bounds[t - 1], hi = b->n;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (b->offsets[mid] < target) lo = mid + 1;
+            else hi = mid;
+        }
+        b->bounds[t] = lo;
+    }
+    b->bounds[threads] = b->n;
+}
+
+// Sorts ints in place: quicksort with median-of-three pivots, finishing
+// small partitions with insertion sort.
+static void sort_ints(int *a, size_t len) {
+    while (len > 24) {
+        int x = a[0], y = a[len / 2], z = a[len - 1];
+        int pivot = x < y ? (y < z ? y : (x < z ? z : x)) : (x < z ? x : (y < z ? z : y));
+
+        size_t i = 0, j = len - 1;
+        for (;;) {
+            while (a[i] < pivot) i++;
+            while (a[j] > pivot) j--;
+            if (i >= j) break;
+            int tmp = a[i];
+            a[i] = a[j];
+            a[j] = tmp;
+            i++;
+            j--;
+        }
+
+        // Recurse into the smaller half, loop on the larger one
+        if (j + 1 < len - j - 1) {
+            sort_ints(a, j + 1);
+            a += j + 1;
+            len -= j + 1;
+        } else {
+            sort_ints(a + j + 1, len - j - 1);
+            len = j + 1;
+        }
+    }
+
+    for (size_t i = 1; i < len; i++) {
+        int x = a[i];
+        size_t j = i;
+        while (j > 0 && a[j - 1] > x) {
+            a[j] = a[j - 1];
+            j--;
+        }
+        a[j] = x;
+    }
+}
+
+// Sorts a row and removes repeated entries, returning the new length.
+static size_t sort_unique(int *row, size_t len) {
+    sort_ints(row, len);
+
+    size_t write = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (i > 0 && row[i] == row[i - 1]) continue;
+        row[write++] = row[i];
+    }
+    return write;
+}
+
+// Sorts and deduplicates the rows in this thread's vertex range.
+static void sort_task(void *ctx, int thread, int threads) {
+    (void)threads;
+    RowBuilder *b = ctx;
+    for (int u = b->bounds[thread]; u < b->bounds[thread + 1]; u++) {
+        size_t begin = b->offsets[u];
+        b->lengths[u] = sort_unique(b->neighbors + begin, b->offsets[u + 1] - begin);
+    }
+}
+
+// Builds one set of sorted, duplicate-free CSR rows with a parallel counting
+// sort over slices of the edges, then sorts and deduplicates every row.
+static int build_rows(RowBuilder *b, int threads, size_t **offsets_out, int **neighbors_out, size_t *m_out) {
+    int n = b->n;
+    if (threads > n) threads = n > 0 ? n : 1;
+    b->counts = calloc((size_t)threads * n + 1, sizeof(size_t));
+    b->offsets = malloc((n + 1) * sizeof(size_t));
+    b->lengths = calloc(n + 1, sizeof(size_t));
+    b->bounds = malloc((threads + 1) * sizeof(int));
+    if (!b->counts || !b->offsets || !b->lengths || !b->bounds) goto fail;
+
+    b->edges = 0;
+    for (int l = 0; l < b->nlists; l++) b->edges += b->lists[l].count;
+    parallel_run(threads, count_task, b);
+
+    // Vertex degrees are unknown yet, so merge the counts over equal vertex ranges
+    for (int t = 0; t <= threads; t++) b->bounds[t] = (int)parallel_slice(n, t, threads);
+    parallel_run(threads, total_task, b);
+    b->offsets[0] = 0;
+    for (int u = 0; u < n; u++) b->offsets[u + 1] += b->offsets[u];
+    parallel_run(threads, cursor_task, b);
+
+    b->neighbors = malloc((b->offsets[n] ? b->offsets[n] : 1) * sizeof(int));
+    if (!b->neighbors) goto fail;
+
+    parallel_run(threads, scatter_task, b);
+    free(b->counts);
+    b->counts = NULL;
+
+    balance_bounds(b, threads);
+    parallel_run(threads, sort_task, b);
+
+    // Squeeze out the removed duplicates; rows only move towards the front.
+    // The final row lengths are the degrees, so they are accumulated here.
+    size_t write = 0;
+    for (int u = 0; u < n; u++) {
+        size_t begin = b->offsets[u];
+        b->offsets[u] = write;
+        memmove(b->neighbors + write, b->neighbors + begin, b->lengths[u] * sizeof(int));
+        write += b->lengths[u];
+        b->degrees[u] += (int)b->lengths[u];
+    }
+    b->offsets[n] = write;
+
+    free(b->lengths);
+    free(b->bounds);
+    *offsets_out = b->offsets;
+    *neighbors_out = b->neighbors;
+    *m_out = write;
+    return 1;
+
+fail:
+    free(b->bounds);
+    free(b->counts);
+    free(b->offsets);
+    free(b->lengths);
+    free(b->neighbors);
+    return 0;
+}
+
+// Builds the out-rows, and for directed graphs the in-rows, from the edge lists.
+Graph* graph_from_edge_lists(int n, const EdgeList *lists, int nlists, int directed, int threads) {
+    Graph *g = calloc(1, sizeof(Graph));
+    if (!g) return NULL;
+    g->n = n;
+    g->directed = directed;
+    g->degrees = calloc(n ? n : 1, sizeof(int));
+    if (!g->degrees) {
+        graph_free(g);
+        return NULL;
+    }
+
+    RowBuilder b = {0};
+    b.n = n;
+    b.lists = lists;
+    b.nlists = nlists;
+    b.symmetric = !directed;
+    b.degrees = g->degrees;
+
+    if (!build_rows(&b, threads, &g->offsets, &g->neighbors, &g->m)) {
+        graph_free(g);
+        return NULL;
+    }
+
+    if (directed) {
+        RowBuilder in = b;
+        size_t in_m;
+        in.reverse = 1;
+        in.neighbors = NULL;
+        if (!build_rows(&in, threads, &g->in_offsets, &g->in_neighbors, &in_m)) {
+            graph_free(g);
+            return NULL;
+        }
+    }
+
+    // The bitset is an optional accelerator; stay on CSR if it cannot be allocated
+    graph_use_backend(g, graph_pick_backend(n, g->m));
+
+    return g;
+}
+
+// Builds the graph from a single edge list on the calling thread.
+Graph* graph_from_edges(int n, Edge *edges, size_t count, int directed) {
+    EdgeList list = {edges, count, count};
+    return graph_from_edge_lists(n, &list, 1, directed, 1);
+}
+
+// Chooses the bitset when rows are dense enough to make word scans cheap.
+GraphBackend graph_pick_backend(int n, size_t m) {
+    if (n <= 0) return GRAPH_CSR;
+
+    size_t words = (size_t)bitset_words(n);
+    size_t bytes = (size_t)n * words * sizeof(uint64_t);
+    double avg_degree = (double)m / n;
+
+    if (bytes <= BITSET_MAX_BYTES && words <= 2 * avg_degree) return GRAPH_BITSET;
+    return GRAPH_CSR;
+}
+
+// Fills the bitset rows from the CSR rows.
+static void fill_bitset(Graph *g) {
+    memset(g->bits, 0, (size_t)g->n * g->words * sizeof(uint64_t));
+    for (int u = 0; u < g->n; u++) {
+        uint64_t *row = g->bits + (size_t)u * g->words;
+        for (size_t i = g->offsets[u]; i < g->offsets[u + 1]; i++) {
+            bitset_set(row, g->neighbors[i]);
+        }
+    }
+}
+
+// Frees an array unless it lives inside the graph's snapshot mapping.
+static void free_owned(const Graph *g, void *p) {
+    const char *base = g->mapping;
+    if (base && (const char*)p >= base && (const char*)p < base + g->mapping_size) return;
+    free(p);
+}
+
+// Encodes one set of rows as gap varints. Returns 0 on allocation failure or
+// if the encoded rows do not fit 32-bit offsets.
+static int pack_rows(int n, const size_t *offsets, const int *neighbors,
+                     uint8_t **packed_out, uint32_t **packed_offsets_out) {
+    uint32_t *packed_offsets = malloc((n + 1) * sizeof(uint32_t));
+    if (!packed_offsets) return 0;
+
+    // Size every row first so the encoded rows get an exact allocation
+    size_t total = 0;
+    packed_offsets[0] = 0;
+    for (int u = 0; u < n; u++) {
+        size_t bytes = 0;
+        int prev = u;
+        for (size_t e = offsets[u]; e < offsets[u + 1]; e++) {
+            int v = neighbors[e];
+            bytes += varint_size(e == offsets[u] ? zigzag_encode(v - prev) : (uint32_t)(v - prev - 1));
+            prev = v;
+        }
+        total += bytes;
+        if (total > UINT32_MAX) {
+            free(packed_offsets);
+            return 0;
+        }
+        packed_offsets[u + 1] = (uint32_t)total;
+    }
+
+    uint8_t *packed = malloc(packed_offsets[n] ? packed_offsets[n] : 1);
+    if (!packed) {
+        free(packed_offsets);
+        return 0;
+    }
+    for (int u = 0; u < n; u++) {
+        uint8_t *p = packed + packed_offsets[u];
+        int prev = u;
+        for (size_t e = offsets[u]; e < offsets[u + 1]; e++) {
+            int v = neighbors[e];
+            p = varint_put(p, e == offsets[u] ? zigzag_encode(v - prev) : (uint32_t)(v - prev - 1));
+            prev = v;
+        }
+    }
+
+    *packed_out = packed;
+    *packed_offsets_out = packed_offsets;
+    return 1;
+}
+
+// Decodes one set of rows encoded by pack_rows(), rebuilding their offsets.
+// Returns 0 on allocation failure.
+static int unpack_rows(const Graph *g, int in, size_t **offsets_out, int **neighbors_out) {
+    size_t *offsets = malloc((g->n + 1) * sizeof(size_t));
+    int *neighbors = malloc((g->m ? g->m : 1) * sizeof(int));
+    if (!offsets || !neighbors) {
+        free(offsets);
+        free(neighbors);
+        return 0;
+    }
+
+    size_t e = 0;
+    offsets[0] = 0;
+    for (int u = 0; u < g->n; u++) {
+        PackedRow row = graph_packed_row(g, u, in);
+        while (packed_row_next(&row, &neighbors[e])) e++;
+        offsets[u + 1] = e;
+    }
+    *offsets_out = offsets;
+    *neighbors_out = neighbors;
+    return 1;
+}
+
+// Replaces the neighbor and offset arrays by encoded rows.
+static int compress_graph(Graph *g) {
+    if (!pack_rows(g->n, g->offsets, g->neighbors, &g->packed, &g->packed_offsets)) return 0;
+    if (g->directed &&
+        !pack_rows(g->n, g->in_offsets, g->in_neighbors, &g->in_packed, &g->in_packed_offsets)) {
+        free(g->packed);
+        free(g->packed_offsets);
+        g->packed = NULL;
+        g->packed_offsets = NULL;
+        return 0;
+    }
+
+    free_owned(g, g->offsets);
+    free_owned(g, g->neighbors);
+    free_owned(g, g->in_offsets);
+    free_owned(g, g->in_neighbors);
+    g->offsets = g->in_offsets = NULL;
+    g->neighbors = g->in_neighbors = NULL;
+    g->backend = GRAPH_COMPRESSED;
+    return 1;
+}
+
+// Restores the neighbor and offset arrays from the encoded rows.
+static int decompress_graph(Graph *g) {
+    size_t *offsets, *in_offsets = NULL;
+    int *neighbors, *in_neighbors = NULL;
+    if (!unpack_rows(g, 0, &offsets, &neighbors)) return 0;
+    if (g->directed && !unpack_rows(g, 1, &in_offsets, &in_neighbors)) {
+        free(offsets);
+        free(neighbors);
+        return 0;
+    }
+
+    free(g->packed);
+    free(g->packed_offsets);
+    free(g->in_packed);
+    free(g->in_packed_offsets);
+    g->packed = g->in_packed = NULL;
+    g->packed_offsets = g->in_packed_offsets = NULL;
+    g->offsets = offsets;
+    g->neighbors = neighbors;
+    g->in_offsets = in_offsets;
+    g->in_neighbors = in_neighbors;
+    g->backend = GRAPH_CSR;
+    return 1;
+}
+
+// Builds or releases the bitset or encoded rows to match the requested backend.
+int graph_use_backend(Graph *g, GraphBackend backend) {
+    if (g->backend == backend && backend != GRAPH_BITSET) return 1;
+    if (g->backend == GRAPH_COMPRESSED && !decompress_graph(g)) return 0;
+
+    if (backend != GRAPH_BITSET) {
+        free(g->bits);
+        g->bits = NULL;
+        g->words = 0;
+        g->backend = GRAPH_CSR;
+        return backend == GRAPH_CSR ? 1 : compress_graph(g);
+    }
+
+    if (!g->bits) {
+        g->words = bitset_words(g->n);
+        size_t count = (size_t)g->n * g->words;
+        g->bits = malloc((count ? count : 1) * sizeof(uint64_t));
+        if (!g->bits) {
+            g->words = 0;
+            g->backend = GRAPH_CSR;
+            return 0;
+        }
+    }
+    fill_bitset(g);
+    g->backend = GRAPH_BITSET;
+    return 1;
+}
+
+// Sums the sizes of all adjacency arrays in use.
+size_t graph_adjacency_bytes(const Graph *g) {
+    int directions = g->directed ? 2 : 1;
+    size_t bytes;
+    if (g->backend == GRAPH_COMPRESSED) {
+        bytes = directions * (size_t)(g->n + 1) * sizeof(uint32_t);
+        bytes += g->packed_offsets[g->n];
+        if (g->directed) bytes += g->in_packed_offsets[g->n];
+    } else {
+        bytes = directions * ((size_t)(g->n + 1) * sizeof(size_t) + g->m * sizeof(int));
+    }
+    if (g->bits) bytes += (size_t)g->n * g->words * sizeof(uint64_t);
+    return bytes;
+}
+
+// Compacts one set of CSR rows, keeping only arcs between live vertices.
+static size_t prune_rows(size_t *offsets, int *neighbors, int n, const int *degrees) {
+    size_t write = 0;
+    for (int u = 0; u < n; u++) {
+        size_t begin = offsets[u], end = offsets[u + 1];
+        offsets[u] = write;
+        if (degrees[u] == 0) continue;
+        for (size_t i = begin; i < end; i++) {
+            if (degrees[neighbors[i]] > 0) neighbors[write++] = neighbors[i];
+        }
+    }
+    offsets[n] = write;
+    return write;
+}
+
+// Drops all arcs touching a vertex with degree 0.
+void graph_prune(Graph *g) {
+    g->m = prune_rows(g->offsets, g->neighbors, g->n, g->degrees);
+    if (g->directed) {
+        prune_rows(g->in_offsets, g->in_neighbors, g->n, g->degrees);
+    }
+    if (g->backend == GRAPH_BITSET) fill_bitset(g);
+}
+
+// Drops the marked arcs, recounts the degrees and, for a directed graph,
+// drops the transposed arcs whose out-arc is gone.
+size_t graph_remove_arcs(Graph *g, const unsigned char *removed) {
+    size_t m = g->m, write = 0;
+    for (int u = 0; u < g->n; u++) {
+        size_t begin = g->offsets[u], end = g->offsets[u + 1];
+        g->offsets[u] = write;
+        for (size_t e = begin; e < end; e++) {
+            if (!removed[e]) g->neighbors[write++] = g->neighbors[e];
+        }
+        g->degrees[u] = (int)(write - g->offsets[u]);
+    }
+    g->offsets[g->n] = write;
+    g->m = write;
+    if (g->backend == GRAPH_BITSET) fill_bitset(g);
+
+    if (g->directed) {
+        write = 0;
+        for (int v = 0; v < g->n; v++) {
+            size_t begin = g->in_offsets[v], end = g->in_offsets[v + 1];
+            g->in_offsets[v] = write;
+            for (size_t e = begin; e < end; e++) {
+                int u = g->in_neighbors[e];
+                if (graph_has_edge(g, u, v)) g->in_neighbors[write++] = u;
+            }
+            g->degrees[v] += (int)(write - g->in_offsets[v]);
+        }
+        g->in_offsets[g->n] = write;
+    }
+    return m - g->m;
+}
+
+// Rebuilds one set of rows under the new numbering given by rank (old -> new).
+static int relabel_rows(int n, const int *order, const int *rank,
+                        size_t **offsets, int **neighbors, size_t m) {
+    size_t *new_offsets = malloc((n + 1) * sizeof(size_t));
+    int *new_neighbors = malloc((m ? m : 1) * sizeof(int));
+    if (!new_offsets || !new_neighbors) {
+        free(new_offsets);
+        free(new_neighbors);
+        return 0;
+    }
+
+    new_offsets[0] = 0;
+    for (int i = 0; i < n; i++) {
+        int old = order[i];
+        size_t begin = (*offsets)[old], end = (*offsets)[old + 1];
+        size_t write = new_offsets[i];
+        for (size_t e = begin; e < end; e++) {
+            new_neighbors[write++] = rank[(*neighbors)[e]];
+        }
+        sort_ints(new_neighbors + new_offsets[i], end - begin);
+        new_offsets[i + 1] = write;
+    }
+
+    *offsets = new_offsets;
+    *neighbors = new_neighbors;
+    return 1;
+}
+
+// Applies the renumbering to the rows, degrees and input ids.
+int graph_relabel(Graph *g, const int *order, int count) {
+    int n = g->n;
+    int *rank = malloc((n ? n : 1) * sizeof(int));
+    int *orig_id = malloc((count ? count : 1) * sizeof(int));
+    int *degrees = malloc((count ? count : 1) * sizeof(int));
+    if (!rank || !orig_id || !degrees) {
+        free(rank);
+        free(orig_id);
+        free(degrees);
+        return 0;
+    }
+    for (int v = 0; v < n; v++) rank[v] = -1;
+    for (int i = 0; i < count; i++) {
+        rank[order[i]] = i;
+        orig_id[i] = graph_orig_id(g, order[i]);
+        degrees[i] = g->degrees[order[i]];
+    }
+
+    size_t *offsets = g->offsets, *in_offsets = g->in_offsets;
+    int *neighbors = g->neighbors, *in_neighbors = g->in_neighbors;
+    if (!relabel_rows(count, order, rank, &offsets, &neighbors, g->m) ||
+        (g->directed && !relabel_rows(count, order, rank, &in_offsets, &in_neighbors, g->m))) {
+        if (offsets != g->offsets) {
+            free(offsets);
+            free(neighbors);
+        }
+        free(rank);
+        free(orig_id);
+        free(degrees);
+        return 0;
+    }
+
+    free_owned(g, g->offsets);
+    free_owned(g, g->neighbors);
+    free_owned(g, g->in_offsets);
+    free_owned(g, g->in_neighbors);
+    free_owned(g, g->orig_id);
+    free_owned(g, g->degrees);
+    g->n = count;
+    g->offsets = offsets;
+    g->neighbors = neighbors;
+    g->in_offsets = in_offsets;
+    g->in_neighbors = in_neighbors;
+    g->orig_id = orig_id;
+    g->degrees = degrees;
+    free(rank);
+
+    // The bitset rows are sized by n, so pick the backend again
+    graph_use_backend(g, GRAPH_CSR);
+    graph_use_backend(g, graph_pick_backend(g->n, g->m));
+    return 1;
+}
+
+// Writes the ranks of the ranked neighbors in the out-row (in != 0: in-row)
+// of v to out, or only counts them if out is NULL. Returns their number.
+static size_t ranked_row(const Graph *g, int v, int in, const int *rank, int *out) {
+    size_t kept = 0;
+    if (g->backend == GRAPH_COMPRESSED) {
+        PackedRow row = graph_packed_row(g, v, in);
+        int w;
+        while (packed_row_next(&row, &w)) {
+            if (rank[w] < 0) continue;
+            if (out) out[kept] = rank[w];
+            kept++;
+        }
+        return kept;
+    }
+
+    const size_t *offsets = in ? g->in_offsets : g->offsets;
+    const int *neighbors = in ? g->in_neighbors : g->neighbors;
+    for (size_t e = offsets[v]; e < offsets[v + 1]; e++) {
+        int w = rank[neighbors[e]];
+        if (w < 0) continue;
+        if (out) out[kept] = w;
+        kept++;
+    }
+    return kept;
+}
+
+// Copies the arcs of one set of rows whose endpoints both have a rank.
+static int subgraph_rows(const Graph *g, int in, const int *vertices,
+                         int count, const int *rank, int *degrees,
+                         size_t **offsets_out, int **neighbors_out, size_t *m_out) {
+    size_t m = 0;
+    for (int i = 0; i < count; i++) m += ranked_row(g, vertices[i], in, rank, NULL);
+
+    size_t *sub_offsets = malloc((count + 1) * sizeof(size_t));
+    int *sub_neighbors = malloc((m ? m : 1) * sizeof(int));
+    if (!sub_offsets || !sub_neighbors) {
+        free(sub_offsets);
+        free(sub_neighbors);
+        return 0;
+    }
+
+    // Ranks increase with the vertex ids, so the rows stay sorted
+    size_t write = 0;
+    sub_offsets[0] = 0;
+    for (int i = 0; i < count; i++) {
+        write += ranked_row(g, vertices[i], in, rank, sub_neighbors + write);
+        sub_offsets[i + 1] = write;
+        degrees[i] += (int)(write - sub_offsets[i]);
+    }
+
+    *offsets_out = sub_offsets;
+    *neighbors_out = sub_neighbors;
+    *m_out = m;
+    return 1;
+}
+
+// Copies the rows of the listed vertices under their new ids.
+Graph* graph_subgraph(const Graph *g, const int *vertices, int count, int *rank) {
+    Graph *sub = calloc(1, sizeof(Graph));
+    if (!sub) return NULL;
+    sub->n = count;
+    sub->directed = g->directed;
+    sub->degrees = calloc(count ? count : 1, sizeof(int));
+    sub->orig_id = malloc((count ? count : 1) * sizeof(int));
+    if (!sub->degrees || !sub->orig_id) {
+        graph_free(sub);
+        return NULL;
+    }
+
+    for (int i = 0; i < count; i++) {
+        rank[vertices[i]] = i;
+        sub->orig_id[i] = graph_orig_id(g, vertices[i]);
+    }
+
+    size_t in_m;
+    int ok = subgraph_rows(g, 0, vertices, count, rank, sub->degrees,
+                           &sub->offsets, &sub->neighbors, &sub->m);
+    if (ok && g->directed) {
+        ok = subgraph_rows(g, 1, vertices, count, rank, sub->degrees,
+                           &sub->in_offsets, &sub->in_neighbors, &in_m);
+    }
+
+    for (int i = 0; i < count; i++) rank[vertices[i]] = -1;
+    if (!ok) {
+        graph_free(sub);
+        return NULL;
+    }
+
+    graph_use_backend(sub, graph_pick_backend(count, sub->m));
+    return sub;
+}
+
+// Frees the graph and all of its arrays.
+void graph_free(Graph *g) {
+    if (!g) return;
+    free_owned(g, g->offsets);
+    free_owned(g, g->neighbors);
+    free_owned(g, g->in_offsets);
+    free_owned(g, g->in_neighbors);
+    free(g->bits);
+    free(g->packed);
+    free(g->packed_offsets);
+    free(g->in_packed);
+    free(g->in_packed_offsets);
+    free_owned(g, g->orig_id);
+    free_owned(g, g->degrees);
+    if (g->mapping) munmap(g->mapping, g->mapping_size);
+    free(g);
+}
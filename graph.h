@@ -0,0 +1,377 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Marco Blok
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// graph.h
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bitset.h"
+#include "varint.h"
+
+// The bitset backend is only chosen while its rows stay within this many bytes
+#define BITSET_MAX_BYTES (64u << 20)
+
+/**
+ * @brief Adjacency backend used for neighbor iteration and edge tests.
+ *
+ * GRAPH_CSR walks the sorted neighbor rows. GRAPH_BITSET additionally keeps one
+ * row of uint64 words per vertex, so edge tests are single bit probes and rows
+ * are scanned a word at a time; it pays off on small, dense graphs.
+ * GRAPH_COMPRESSED replaces the neighbor arrays by gap-encoded varint rows,
+ * decoded sequentially while iterating; it trades some CPU for about a third of
+ * the neighbor memory on graphs with locality. It is never picked automatically.
+ */
+typedef enum {
+    GRAPH_CSR,
+    GRAPH_BITSET,
+    GRAPH_COMPRESSED
+} GraphBackend;
+
+/**
+ * @brief A single edge (or arc) as read from the input.
+ */
+typedef struct {
+    int u, v;
+} Edge;
+
+/**
+ * @brief Growable array of edges, e.g. the edges read by one parser thread.
+ */
+typedef struct {
+    Edge *edges;
+    size_t count;
+    size_t capacity;
+} EdgeList;
+
+/**
+ * @brief Graph stored in compressed sparse row (CSR) form.
+ *
+ * The out-neighbors of vertex v are neighbors[offsets[v] .. offsets[v + 1]),
+ * sorted in increasing order. Undirected edges are stored once in each
+ * direction. Directed graphs additionally keep the transposed adjacency in
+ * in_offsets / in_neighbors so that in-neighbors can be visited in O(deg).
+ * The degree array is filled while the rows are built; pruning stages lower it
+ * while they run and drop the arcs of vertices whose degree reached 0.
+ *
+ * With the compressed backend, the offset and neighbor arrays are NULL and every
+ * row is stored in packed / in_packed instead: the first neighbor as the
+ * zigzag-encoded difference to the row's vertex, every further neighbor as the
+ * gap to its predecessor minus one, all as varints. Rows must then be read with
+ * graph_packed_row(). The byte offsets of the rows are 32-bit, which bounds each
+ * set of encoded rows to 4 GiB.
+ */
+typedef struct {
+    int n;                  // Number of vertex slots
+    size_t m;               // Number of stored arcs
+    int directed;
+    size_t *offsets;        // n + 1 row offsets into neighbors (else NULL)
+    int *neighbors;         // m sorted out-neighbors (else NULL)
+    size_t *in_offsets;     // Transposed row offsets (directed only, else NULL)
+    int *in_neighbors;      // Transposed neighbors (directed only, else NULL)
+    GraphBackend backend;   // Backend used for neighbor iteration
+    int words;              // Words per bitset row (bitset backend only)
+    uint64_t *bits;         // n x words out-adjacency bits (bitset backend only, else NULL)
+    uint8_t *packed;        // Encoded out-rows (compressed backend only, else NULL)
+    uint32_t *packed_offsets; // n + 1 byte offsets into packed
+    uint8_t *in_packed;     // Encoded in-rows (compressed backend, directed only, else NULL)
+    uint32_t *in_packed_offsets;
+    void *mapping;          // Snapshot mapping the arrays may point into (else NULL)
+    size_t mapping_size;
+    int *degrees;           // Out- plus in-degree of every vertex; 0 marks a pruned vertex
+    int *orig_id;           // Input vertex id of every vertex after relabelling or compaction (else NULL)
+} Graph;
+
+/**
+ * @brief Builds a CSR graph from an edge list.
+ *
+ * Self-loops and repeated edges are discarded, as only simple graphs are supported.
+ * The adjacency backend is picked from n and m with graph_pick_backend().
+ *
+ * @param n         Number of vertex slots; every endpoint must lie in [0, n).
+ * @param edges     Array of edges; left untouched, caller keeps ownership.
+ * @param count     Number of edges in the array.
+ * @param directed  Non-zero if every edge is an arc u -> v; 0 if undirected.
+ * @return          Allocated graph, or NULL on allocation failure.
+ */
+Graph* graph_from_edges(int n, Edge *edges, size_t count, int directed);
+
+/**
+ * @brief Builds a CSR graph from several edge lists using multiple threads.
+ *
+ * Rows are built with a parallel counting sort on the source vertex (and on the
+ * target vertex for the transposed rows of directed graphs): every thread
+ * counts the arcs of its own slice of the edges per row, and after a prefix sum
+ * over the threads scatters them through its own row cursors. This takes
+ * threads x n counters. Self-loops are dropped while bucketing and repeated
+ * edges while sorting each row. The degrees are taken from the final row lengths.
+ *
+ * @param n         Number of vertex slots; every endpoint must lie in [0, n).
+ * @param lists     Array of edge lists; left untouched, caller keeps ownership.
+ * @param nlists    Number of edge lists.
+ * @param directed  Non-zero if every edge is an arc u -> v; 0 if undirected.
+ * @param threads   Number of threads to use.
+ * @return          Allocated graph, or NULL on allocation failure.
+ */
+Graph* graph_from_edge_lists(int n, const EdgeList *lists, int nlists, int directed, int threads);
+
+/**
+ * @brief Picks the adjacency backend for a graph with n vertices and m arcs.
+ *
+ * The bitset is chosen when a row of words is no longer than twice the average
+ * degree, i.e. when scanning a bitset row costs about as much as walking the CSR
+ * row, and the whole bitset stays within BITSET_MAX_BYTES.
+ *
+ * @param n         Number of vertex slots.
+ * @param m         Number of stored arcs.
+ * @return          The preferred backend.
+ */
+GraphBackend graph_pick_backend(int n, size_t m);
+
+/**
+ * @brief Switches the graph to the given adjacency backend.
+ *
+ * Builds the bitset rows from the CSR when switching to GRAPH_BITSET and frees
+ * them when switching back to GRAPH_CSR. Switching to GRAPH_COMPRESSED encodes
+ * the rows and frees the offset and neighbor arrays; switching away decodes
+ * them again.
+ * Pruning, relabelling and snapshot writing need the neighbor arrays, so they
+ * must run before the graph is switched to GRAPH_COMPRESSED.
+ *
+ * @param g         Graph to update.
+ * @param backend   Backend to use.
+ * @return          1 on success, 0 on allocation failure or if the encoded rows
+ *                  exceed 4 GiB (the graph is left on GRAPH_CSR, or on
+ *                  GRAPH_COMPRESSED if decoding the rows failed).
+ */
+int graph_use_backend(Graph *g, GraphBackend backend);
+
+/**
+ * @brief Returns the number of bytes held by the adjacency of the graph.
+ *
+ * Counts the row offsets and neighbors (or encoded rows) in both directions and
+ * the bitset rows, but not the degree and id arrays.
+ */
+size_t graph_adjacency_bytes(const Graph *g);
+
+/**
+ * @brief Removes every arc incident to a vertex whose degree is 0.
+ *
+ * Used after pruning stages that mark removed vertices by zeroing their entry in
+ * g->degrees. Rows are compacted in place, so neighbor lists stay contiguous and
+ * sorted, and the bitset rows are rebuilt when the bitset backend is in use.
+ *
+ * @param g         Graph to prune.
+ */
+void graph_prune(Graph *g);
+
+/**
+ * @brief Removes the marked arcs from the graph.
+ *
+ * removed[e] marks the arc stored at neighbors[e]. For an undirected graph the
+ * marks must be symmetric; for a directed graph the matching transposed arcs
+ * are dropped as well. Rows are compacted in place, the degrees are recounted
+ * from the remaining arcs and the bitset rows are rebuilt when in use. g must
+ * still have its neighbor arrays, i.e. not use GRAPH_COMPRESSED.
+ *
+ * @param g         Graph to update.
+ * @param removed   One flag per stored arc (g->m entries).
+ * @return          Number of arcs removed.
+ */
+size_t graph_remove_arcs(Graph *g, const unsigned char *removed);
+
+/**
+ * @brief Renumbers the vertices so that vertex order[i] becomes vertex i.
+ *
+ * Only the count listed vertices are kept, so the graph shrinks to count vertex
+ * slots; every vertex left out must have no arcs. Rows are rebuilt (and
+ * re-sorted) under the new numbering, the degrees are permuted to match,
+ * orig_id is updated so that every vertex can still be mapped back to its id in
+ * the input file and the backend is picked again for the new size.
+ *
+ * @param g         Graph to relabel.
+ * @param order     Distinct vertices: order[i] is the current id of new vertex i.
+ * @param count     Number of entries in order, i.e. the new number of vertex slots.
+ * @return          1 on success, 0 on allocation failure (the graph is left unchanged).
+ */
+int graph_relabel(Graph *g, const int *order, int count);
+
+/**
+ * @brief Builds the subgraph induced by a set of vertices as a new graph.
+ *
+ * Vertex vertices[i] becomes vertex i and only arcs between listed vertices are
+ * kept. The degrees count the kept arcs, orig_id maps every vertex to its input
+ * id (through g->orig_id) and the backend is picked for the new size. g may
+ * use any backend.
+ *
+ * @param g         Graph to take the subgraph of; left unchanged.
+ * @param vertices  Distinct vertices of g in increasing order.
+ * @param count     Number of entries in vertices.
+ * @param rank      Scratch array of g->n entries, all -1 on entry and on return.
+ * @return          Allocated graph, or NULL on allocation failure.
+ */
+Graph* graph_subgraph(const Graph *g, const int *vertices, int count, int *rank);
+
+/**
+ * @brief Returns a view of a directed graph with every arc reversed.
+ *
+ * The view shares the arrays of g and must not be freed. Its out-rows are the
+ * in-rows of g (CSR or compressed); a bitset backend falls back to the CSR
+ * rows, as the bitset only holds the out-rows.
+ */
+static inline Graph graph_transposed(const Graph *g) {
+    Graph t = *g;
+    t.offsets = g->in_offsets;
+    t.neighbors = g->in_neighbors;
+    t.in_offsets = g->offsets;
+    t.in_neighbors = g->neighbors;
+    t.packed = g->in_packed;
+    t.packed_offsets = g->in_packed_offsets;
+    t.in_packed = g->packed;
+    t.in_packed_offsets = g->packed_offsets;
+    if (t.backend == GRAPH_BITSET) t.backend = GRAPH_CSR;
+    t.bits = NULL;
+    return t;
+}
+
+/**
+ * @brief Returns the input id of vertex v.
+ */
+static inline int graph_orig_id(const Graph *g, int v) {
+    return g->orig_id ? g->orig_id[v] : v;
+}
+
+/**
+ * @brief Frees all memory owned by the graph.
+ *
+ * Arrays that point into a snapshot mapping are released by unmapping it.
+ *
+ * @param g         Graph to free (may be NULL).
+ */
+void graph_free(Graph *g);
+
+/**
+ * @brief Returns the bitset row of vertex v (bitset backend only).
+ */
+static inline const uint64_t* graph_bitset_row(const Graph *g, int v) {
+    return g->bits + (size_t)v * g->words;
+}
+
+/**
+ * @brief Sequential decoder over one encoded row (compressed backend only).
+ */
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+    int prev;           // Last decoded neighbor; the row's vertex before the first
+    int first;          // Non-zero until the first neighbor has been decoded
+} PackedRow;
+
+/**
+ * @brief Starts decoding the out-row (in != 0: in-row) of vertex v.
+ */
+static inline PackedRow graph_packed_row(const Graph *g, int v, int in) {
+    const uint8_t *packed = in ? g->in_packed : g->packed;
+    const uint32_t *offsets = in ? g->in_packed_offsets : g->packed_offsets;
+    PackedRow row = {packed + offsets[v], packed + offsets[v + 1], v, 1};
+    return row;
+}
+
+/**
+ * @brief Decodes the next neighbor of the row into *v; returns 0 at the end of the row.
+ */
+static inline int packed_row_next(PackedRow *row, int *v) {
+    if (row->p == row->end) return 0;
+    uint32_t x;
+    row->p = varint_get(row->p, &x);
+    if (row->first) {
+        row->prev += zigzag_decode(x);
+        row->first = 0;
+    } else {
+        row->prev += (int)x + 1;
+    }
+    *v = row->prev;
+    return 1;
+}
+
+/**
+ * @brief Returns the number of neighbors in an encoded row without decoding it.
+ */
+static inline int packed_row_count(PackedRow row) {
+    int count = 0;
+    for (const uint8_t *p = row.p; p < row.end; p++) count += *p < 0x80;
+    return count;
+}
+
+/**
+ * @brief Returns the number of out-neighbors of vertex v.
+ *
+ * Constant time on the CSR and bitset backends; with the compressed backend
+ * the encoded row is scanned, so loops should take it once per vertex.
+ */
+static inline int graph_out_degree(const Graph *g, int v) {
+    if (g->backend == GRAPH_COMPRESSED) return packed_row_count(graph_packed_row(g, v, 0));
+    return (int)(g->offsets[v + 1] - g->offsets[v]);
+}
+
+/**
+ * @brief Returns the number of in-neighbors of vertex v (out-degree if undirected).
+ *
+ * Scans the encoded row with the compressed backend, like graph_out_degree().
+ */
+static inline int graph_in_degree(const Graph *g, int v) {
+    if (!g->directed) return graph_out_degree(g, v);
+    if (g->backend == GRAPH_COMPRESSED) return packed_row_count(graph_packed_row(g, v, 1));
+    return (int)(g->in_offsets[v + 1] - g->in_offsets[v]);
+}
+
+/**
+ * @brief Returns non-zero if the arc u -> v is present.
+ *
+ * A single bit probe with the bitset backend, a scan of the encoded row with the
+ * compressed backend and a binary search over the sorted row otherwise.
+ */
+static inline int graph_has_edge(const Graph *g, int u, int v) {
+    if (g->backend == GRAPH_BITSET) return bitset_test(graph_bitset_row(g, u), v);
+    if (g->backend == GRAPH_COMPRESSED) {
+        PackedRow row = graph_packed_row(g, u, 0);
+        int w;
+        while (packed_row_next(&row, &w)) {
+            if (w >= v) return w == v;
+        }
+        return 0;
+    }
+
+    size_t lo = g->offsets[u], hi = g->offsets[u + 1];
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (g->neighbors[mid] < v) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo < g->offsets[u + 1] && g->neighbors[lo] == v;
+}
+
+#endif // GRAPH_H
\ No newline at end of file
@@ -24,104 +24,471 @@
 
 // graph_io.c
 #include "graph_io.h"
+#include "parallel.h"
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-/**
- * Parses a graph file and builds the adjacency matrix.
- * Supports "*vertices N" and "*edges" format.
- */
-int** parse(FILE *file, int *n, int directed) {
-    char line[256];
+// Size of the read buffer used when streaming from stdin
+#define STREAM_CHUNK (1 << 20)
 
-    // Read number of vertices
-    if (fgets(line, sizeof(line), file) == NULL || sscanf(line, "*vertices %d", n) != 1) {
-        fprintf(stderr, "Invalid or missing *vertices line.\n");
-        fclose(file);
-        return NULL;
+// Minimum number of bytes of an edge section handed to each parser thread
+#define PARSE_CHUNK_MIN (256 << 10)
+
+// Pajek section the reader is currently in
+typedef enum {
+    SECTION_NONE,
+    SECTION_VERTICES,   // vertex labels, ignored
+    SECTION_PAIRS,      // *edges / *arcs: one "u v [weight]" per line
+    SECTION_LISTS,      // *edgeslist / *arcslist: "u v1 v2 ..." per line
+    SECTION_OTHER       // unsupported section, ignored
+} Section;
+
+// Vertex ids are compacted while parsing once the declared vertex range is more
+// than this many times larger than the number of edge endpoints
+#define SPARSE_ID_RATIO 4
+
+// Incremental Pajek reader state, fed with complete lines
+typedef struct {
+    int n;              // Vertex slots, 0 until *vertices has been read
+    Section section;
+    EdgeList edges;     // Edges read sequentially
+    EdgeList *chunks;   // Edges read by parser threads
+    int nchunks;
+    int failed;
+} PajekReader;
+
+static inline int is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+static inline const char* skip_blanks(const char *p, const char *end) {
+    while (p < end && is_blank(*p)) p++;
+    return p;
+}
+
+// Scans a (possibly negative) decimal integer token at p.
+// Returns the position after the token, or NULL if p does not start an
+// integer token. Values that do not fit in an int are clamped to INT_MIN/INT_MAX.
+static const char* scan_int(const char *p, const char *end, int *out) {
+    int negative = 0;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
     }
+    if (p == end || (unsigned)(*p - '0') > 9) return NULL;
 
-    if (*n <= 0) {
-        fprintf(stderr, "Invalid number of vertices.\n");
-        fclose(file);
-        return NULL;
+    long long value = 0;
+    while (p < end && (unsigned)(*p - '0') <= 9) {
+        if (value <= INT_MAX) value = value * 10 + (*p - '0');
+        p++;
     }
+    if (p < end && !is_blank(*p)) return NULL; // e.g. a fractional weight
 
-    // Adjust for 1-based vertex indexing in input
-    *n += 1;
+    if (value > INT_MAX) value = (long long)INT_MAX + negative;
+    *out = (int)(negative ? -value : value);
+    return p;
+}
 
-    // Allocate adjacency matrix
-    int **adj = malloc(*n * sizeof(int *));
-    for (int i = 0; i < *n; i++) {
-        adj[i] = calloc(*n, sizeof(int));
+// Case-insensitive match of a section keyword of exactly the given length.
+static int keyword_is(const char *word, size_t len, const char *keyword) {
+    if (strlen(keyword) != len) return 0;
+    for (size_t i = 0; i < len; i++) {
+        if (tolower((unsigned char)word[i]) != keyword[i]) return 0;
     }
+    return 1;
+}
 
-    // Skip to *edges line
-    while (fgets(line, sizeof(line), file)) {
-        if (strncmp(line, "*edges", 6) == 0 || strncmp(line, "*Edges", 6) == 0) {
-            break;
+// Appends an edge, reporting endpoints outside the declared vertex range.
+static void add_edge(PajekReader *r, int u, int v) {
+    if (u < 0 || v < 0 || u >= r->n || v >= r->n) {
+        fprintf(stderr, "Invalid edge: %d %d\n", u, v);
+        return;
+    }
+    EdgeList *list = &r->edges;
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 1024;
+        Edge *grown = realloc(list->edges, capacity * sizeof(Edge));
+        if (!grown) {
+            fprintf(stderr, "Memory allocation failed for edge list\n");
+            r->failed = 1;
+            return;
         }
+        list->edges = grown;
+        list->capacity = capacity;
+    }
+    list->edges[list->count].u = u;
+    list->edges[list->count].v = v;
+    list->count++;
+}
+
+// Handles a "*keyword ..." line.
+static void read_section_header(PajekReader *r, const char *p, const char *end) {
+    const char *word = ++p;
+    while (p < end && !is_blank(*p)) p++;
+    size_t len = (size_t)(p - word);
+
+    if (keyword_is(word, len, "vertices")) {
+        int n;
+        if (!scan_int(skip_blanks(p, end), end, &n)) {
+            fprintf(stderr, "Invalid or missing *vertices line.\n");
+            r->failed = 1;
+        } else if (n <= 0 || n == INT_MAX) {
+            fprintf(stderr, "Invalid number of vertices.\n");
+            r->failed = 1;
+        } else {
+            // Adjust for 1-based vertex indexing in input
+            r->n = n + 1;
+        }
+        r->section = SECTION_VERTICES;
+        return;
+    }
+
+    if (keyword_is(word, len, "edges") || keyword_is(word, len, "arcs")) {
+        r->section = SECTION_PAIRS;
+    } else if (keyword_is(word, len, "edgeslist") || keyword_is(word, len, "arcslist")) {
+        r->section = SECTION_LISTS;
+    } else {
+        r->section = SECTION_OTHER;
+        return;
+    }
+
+    if (r->n == 0) {
+        fprintf(stderr, "Invalid or missing *vertices line.\n");
+        r->failed = 1;
+    }
+}
+
+// Tokenizes one line [p, end) without copying it.
+static void read_line(PajekReader *r, const char *p, const char *end) {
+    p = skip_blanks(p, end);
+    if (p == end || *p == '%') return; // blank line or comment
+
+    if (*p == '*') {
+        read_section_header(r, p, end);
+        return;
     }
 
-    // Read edges and populate adjacency matrix
     int u, v;
-    while (fgets(line, sizeof(line), file)) {
-        if (sscanf(line, "%d %d", &u, &v) == 2) {
-            if (u < 0 || v < 0 || u >= *n || v >= *n) {
-                fprintf(stderr, "Invalid edge: %d %d\n", u, v);
-                continue;
+    if (r->section == SECTION_PAIRS) {
+        const char *q = scan_int(p, end, &u);
+        if (q && scan_int(skip_blanks(q, end), end, &v)) add_edge(r, u, v);
+    } else if (r->section == SECTION_LISTS) {
+        const char *q = scan_int(p, end, &u);
+        while (q && !r->failed) {
+            q = skip_blanks(q, end);
+            if (q == end) break;
+            q = scan_int(q, end, &v);
+            if (q) add_edge(r, u, v);
+        }
+    }
+}
+
+// Processes all complete lines in [data, data + len).
+// Returns the number of bytes consumed; unless final is set, a trailing
+// line without newline is left for the next call.
+static size_t read_lines(PajekReader *r, const char *data, size_t len, int final) {
+    const char *p = data;
+    const char *end = data + len;
+
+    while (p < end && !r->failed) {
+        const char *eol = memchr(p, '\n', (size_t)(end - p));
+        if (!eol) {
+            if (!final) break;
+            eol = end;
+        }
+        read_line(r, p, eol);
+        p = eol < end ? eol + 1 : end;
+    }
+    return (size_t)(p - data);
+}
+
+// Returns the start of the first section header line in [begin, end), or end.
+// begin must be the start of a line.
+static const char* find_section_end(const char *begin, const char *end) {
+    const char *p = begin;
+    while (p < end) {
+        const char *star = memchr(p, '*', (size_t)(end - p));
+        if (!star) return end;
+
+        // A header has only blanks before the '*' on its line
+        const char *q = star;
+        while (q > begin && is_blank(q[-1])) q--;
+        if (q == begin || q[-1] == '\n') return q;
+        p = star + 1;
+    }
+    return end;
+}
+
+// Moves p forward to the start of a line within [begin, end].
+static const char* align_to_line(const char *p, const char *begin, const char *end) {
+    if (p <= begin) return begin;
+    if (p >= end) return end;
+    const char *eol = memchr(p - 1, '\n', (size_t)(end - (p - 1)));
+    return eol ? eol + 1 : end;
+}
+
+// A section of edge lines split over parser threads
+typedef struct {
+    const char *begin;
+    const char *end;
+    PajekReader *readers;   // One per thread
+} ChunkJob;
+
+// Parses this thread's newline-aligned byte range of the section.
+static void parse_chunk_task(void *ctx, int thread, int threads) {
+    ChunkJob *job = ctx;
+    size_t size = (size_t)(job->end - job->begin);
+    const char *lo = align_to_line(job->begin + parallel_slice(size, thread, threads), job->begin, job->end);
+    const char *hi = align_to_line(job->begin + parallel_slice(size, thread + 1, threads), job->begin, job->end);
+    if (lo < hi) read_lines(&job->readers[thread], lo, (size_t)(hi - lo), 1);
+}
+
+// Parses an edge section [begin, end) on several threads, each into its own edge list.
+static void read_section_parallel(PajekReader *r, const char *begin, const char *end, int threads) {
+    PajekReader *readers = calloc(threads, sizeof(PajekReader));
+    EdgeList *chunks = realloc(r->chunks, (r->nchunks + threads) * sizeof(EdgeList));
+    if (!readers || !chunks) {
+        fprintf(stderr, "Memory allocation failed for parser threads\n");
+        free(readers);
+        if (chunks) r->chunks = chunks;
+        r->failed = 1;
+        return;
+    }
+    r->chunks = chunks;
+
+    for (int t = 0; t < threads; t++) {
+        readers[t].n = r->n;
+        readers[t].section = r->section;
+    }
+
+    ChunkJob job = {begin, end, readers};
+    parallel_run(threads, parse_chunk_task, &job);
+
+    for (int t = 0; t < threads; t++) {
+        r->chunks[r->nchunks++] = readers[t].edges;
+        if (readers[t].failed) r->failed = 1;
+    }
+    free(readers);
+}
+
+// Maps the file and tokenizes it in place. Large edge sections are split into
+// newline-aligned byte ranges that are parsed concurrently.
+static int read_mapped(PajekReader *r, int fd, int threads) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        perror("Error reading file");
+        return 0;
+    }
+    if (st.st_size == 0) return 1;
+
+    size_t size = (size_t)st.st_size;
+    char *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        perror("Error mapping file");
+        return 0;
+    }
+    posix_madvise(data, size, POSIX_MADV_SEQUENTIAL);
+
+    const char *p = data;
+    const char *end = data + size;
+    while (p < end && !r->failed) {
+        // Read one line at a time until an edge section starts
+        const char *eol = memchr(p, '\n', (size_t)(end - p));
+        const char *next = eol ? eol + 1 : end;
+        read_line(r, p, eol ? eol : end);
+        p = next;
+
+        if (r->failed || (r->section != SECTION_PAIRS && r->section != SECTION_LISTS)) continue;
+
+        const char *section_end = find_section_end(p, end);
+        size_t bytes = (size_t)(section_end - p);
+        int workers = threads;
+        if ((size_t)workers > bytes / PARSE_CHUNK_MIN) workers = (int)(bytes / PARSE_CHUNK_MIN);
+
+        if (workers > 1) {
+            read_section_parallel(r, p, section_end, workers);
+        } else {
+            read_lines(r, p, bytes, 1);
+        }
+        p = section_end;
+    }
+
+    munmap(data, size);
+    return 1;
+}
+
+// Streams from a file descriptor (e.g. a pipe) through a reusable buffer,
+// carrying a partial last line over to the next read.
+static int read_stream(PajekReader *r, int fd) {
+    size_t capacity = STREAM_CHUNK;
+    size_t filled = 0;
+    char *buffer = malloc(capacity);
+    if (!buffer) {
+        fprintf(stderr, "Memory allocation failed for read buffer\n");
+        return 0;
+    }
+
+    for (;;) {
+        if (filled == capacity) {
+            // A single line longer than the buffer
+            char *grown = realloc(buffer, capacity * 2);
+            if (!grown) {
+                fprintf(stderr, "Memory allocation failed for read buffer\n");
+                free(buffer);
+                return 0;
             }
-            adj[u][v] = 1;
-            if (!directed) adj[v][u] = 1;
+            buffer = grown;
+            capacity *= 2;
+        }
+
+        ssize_t got = read(fd, buffer + filled, capacity - filled);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            perror("Error reading input");
+            free(buffer);
+            return 0;
+        }
+        filled += (size_t)got;
+
+        size_t used = read_lines(r, buffer, filled, got == 0);
+        memmove(buffer, buffer + used, filled - used);
+        filled -= used;
+        if (got == 0 || r->failed) break;
+    }
+
+    free(buffer);
+    return 1;
+}
+
+static int compare_ints(const void *a, const void *b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Renumbers the endpoints of all edges to 0 .. count - 1, keeping the order
+// of their input ids. Returns the input id of every new vertex, or NULL on
+// allocation failure.
+static int* compact_ids(EdgeList *lists, int nlists, int *count) {
+    size_t endpoints = 0;
+    for (int i = 0; i < nlists; i++) endpoints += 2 * lists[i].count;
+
+    int *ids = malloc((endpoints ? endpoints : 1) * sizeof(int));
+    if (!ids) return NULL;
+
+    size_t k = 0;
+    for (int i = 0; i < nlists; i++) {
+        for (size_t e = 0; e < lists[i].count; e++) {
+            ids[k++] = lists[i].edges[e].u;
+            ids[k++] = lists[i].edges[e].v;
         }
     }
+    qsort(ids, k, sizeof(int), compare_ints);
 
-    fclose(file);
-    return adj;
+    size_t unique = 0;
+    for (size_t i = 0; i < k; i++) {
+        if (unique == 0 || ids[i] != ids[unique - 1]) ids[unique++] = ids[i];
+    }
+
+    for (int i = 0; i < nlists; i++) {
+        for (size_t e = 0; e < lists[i].count; e++) {
+            Edge *edge = &lists[i].edges[e];
+            edge->u = (int)((int*)bsearch(&edge->u, ids, unique, sizeof(int), compare_ints) - ids);
+            edge->v = (int)((int*)bsearch(&edge->v, ids, unique, sizeof(int), compare_ints) - ids);
+        }
+    }
+
+    int *shrunk = realloc(ids, (unique ? unique : 1) * sizeof(int));
+    *count = (int)unique;
+    return shrunk ? shrunk : ids;
 }
 
 /**
- * Computes the degree of each vertex.
- * In directed graphs, considers both in-degree and out-degree.
+ * Parses a graph file and builds the CSR graph.
+ * Supports "*vertices N" followed by "*edges"/"*arcs" (one pair per line)
+ * or "*edgeslist"/"*arcslist" (a vertex and its neighbors per line) sections.
+ * Regular files are memory-mapped; "-" or any non-seekable input is streamed.
+ * Edge sections of mapped files are parsed and turned into CSR rows on up to
+ * threads threads.
  */
-int *count_degrees(int **adj, int n, int directed) {
-    int *degrees = malloc(n * sizeof(int));
-
-    for (int i = 0; i < n; i++) {
-        int degree = 0;
-        for (int j = 0; j < n; j++) {
-            if (adj[i][j] == 1) {
-                degree++;
-            }
-            if (directed && adj[j][i] == 1) {
-                degree++; // count in-degree for directed
-            }
+Graph* parse(const char *filename, int directed, int threads) {
+    int fd = strcmp(filename, "-") == 0 ? STDIN_FILENO : open(filename, O_RDONLY);
+    if (fd < 0) {
+        perror("Error opening file");
+        return NULL;
+    }
+
+    PajekReader reader = {0};
+    struct stat st;
+    int ok;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        ok = read_mapped(&reader, fd, threads);
+    } else {
+        ok = read_stream(&reader, fd);
+    }
+    if (fd != STDIN_FILENO) close(fd);
+
+    if (ok && !reader.failed && reader.n == 0) {
+        fprintf(stderr, "Invalid or missing *vertices line.\n");
+        reader.failed = 1;
+    }
+    // Gather the sequentially read edges and the per-thread edge lists
+    Graph *g = NULL;
+    EdgeList *lists = malloc((reader.nchunks + 1) * sizeof(EdgeList));
+    if (ok && !reader.failed && lists) {
+        lists[0] = reader.edges;
+        for (int i = 0; i < reader.nchunks; i++) lists[i + 1] = reader.chunks[i];
+
+        // Size the graph by the ids in use when they are sparse in the declared range
+        int n = reader.n;
+        int *ids = NULL;
+        size_t endpoints = 0;
+        for (int i = 0; i <= reader.nchunks; i++) endpoints += 2 * lists[i].count;
+        if ((size_t)n / SPARSE_ID_RATIO > endpoints) {
+            ids = compact_ids(lists, reader.nchunks + 1, &n);
+        }
+
+        g = graph_from_edge_lists(n, lists, reader.nchunks + 1, directed, threads);
+        if (g) {
+            g->orig_id = ids;
+        } else {
+            free(ids);
+            fprintf(stderr, "Memory allocation failed for graph\n");
         }
-        degrees[i] = degree;
+    } else if (ok && !reader.failed) {
+        fprintf(stderr, "Memory allocation failed for edge list\n");
     }
-    return degrees;
+
+    free(lists);
+    free(reader.edges.edges);
+    for (int i = 0; i < reader.nchunks; i++) free(reader.chunks[i].edges);
+    free(reader.chunks);
+    return g;
 }
 
 /**
- * Utility function to print the adjacency matrix.
+ * Utility function to print the adjacency lists.
  */
-void print_adjacency_matrix(int **adj, int n) {
-    printf("Adjacency Matrix (%d x %d):\n", n, n);
-    for (int i = 0; i < n; i++) {
-        for (int j = 0; j < n; j++) {
-            printf("%d ", adj[i][j]);
+void print_adjacency_lists(const Graph *g) {
+    printf("Adjacency Lists (%d vertices, %zu arcs):\n", g->n, g->m);
+    for (int i = 0; i < g->n; i++) {
+        printf("%d:", i);
+        for (size_t j = g->offsets[i]; j < g->offsets[i + 1]; j++) {
+            printf(" %d", g->neighbors[j]);
         }
         printf("\n");
     }
 }
 
 /**
- * Frees the allocated memory for the adjacency matrix and degrees array.
+ * Frees the allocated memory for the graph and its degrees array.
  */
-void free_adjacency_matrix(int **adj, int *degrees, int n) {
-    for (int i = 0; i < n; i++) {
-        free(adj[i]);
-    }
-    free(degrees);
-    free(adj);
+void free_graph(Graph *g) {
+    graph_free(g);
 }
@@ -28,43 +28,39 @@
 
 #include <stdio.h>
 
-/**
- * @brief Parses a graph file in Pajek .net format and builds an adjacency matrix.
- *
- * @param file      Pointer to an open file containing the graph.
- * @param n         Output parameter that receives the number of vertices (+1 if 1-based indexing).
- * @param directed  Non-zero if the graph is directed; 0 if undirected.
- * @return          Allocated n x n adjacency matrix.
- *                  Returns NULL on error. Caller is responsible for freeing the matrix.
- */
-int** parse(FILE *file, int *n, int directed);
+#include "graph.h"
 
 /**
- * @brief Computes degrees for each vertex in the graph.
+ * @brief Parses a graph file in Pajek .net format and builds a CSR graph.
+ *
+ * Regular files are memory-mapped and tokenized in place; "-" reads from stdin.
+ * Accepted sections are *vertices, *edges, *arcs, *edgeslist and *arcslist
+ * (case-insensitive). Whether a listed pair is an arc or an edge is decided by
+ * the directed flag, not by the section name. Vertex labels and unknown sections
+ * are skipped. The graph holds n + 1 vertex slots to allow 1-based vertex indexing.
+ * Large edge sections of regular files are split on line boundaries and parsed
+ * concurrently; the CSR is then built with a parallel counting sort.
  *
- * @param adj       Adjacency matrix of the graph.
- * @param n         Number of vertices.
- * @param directed  Non-zero for directed graphs (in-degree + out-degree), 0 for undirected.
- * @return          Allocated array of vertex degrees.
- *                  Caller must free the returned array.
+ * @param filename  Path of the graph file, or "-" for stdin.
+ * @param directed  Non-zero if the graph is directed; 0 if undirected.
+ * @param threads   Number of threads used for parsing and CSR construction.
+ * @return          Allocated graph.
+ *                  Returns NULL on error. Caller is responsible for freeing the graph.
  */
-int * count_degrees(int **adj, int n, int directed);
+Graph* parse(const char *filename, int directed, int threads);
 
 /**
- * @brief Prints the adjacency matrix to stdout.
+ * @brief Prints the adjacency list of every vertex to stdout.
  *
- * @param adj       Adjacency matrix to print.
- * @param n         Number of vertices (matrix is n x n).
+ * @param g         Graph to print.
  */
-void print_adjacency_matrix(int **adj, int n);
+void print_adjacency_lists(const Graph *g);
 
 /**
- * @brief Frees the memory allocated for the adjacency matrix and degree array.
+ * @brief Frees the memory allocated for the graph, including its degree array.
  *
- * @param adj       Adjacency matrix to free.
- * @param degrees   Array of degrees to free.
- * @param n         Number of vertices.
+ * @param g         Graph to free.
  */
-void free_adjacency_matrix(int **adj, int *degrees, int n);
+void free_graph(Graph *g);
 
 #endif // GRAPH_IO_H
\ No newline at end of file
@@ -24,29 +24,80 @@
 
 // main.c
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "graph_io.h"
 #include "pre_processing.h"
 #include "paths.h"
 #include "pathjoin.h"
+#include "snapshot.h"
+#include "parallel.h"
+#include "reorder.h"
+#include "estimate.h"
+#include "components.h"
+#include "chains.h"
+#include "analysis.h"
+#include "ego.h"
 
 #define MAX_CONFIG 4
 
+static const char* backend_names[] = {"csr", "bitset", "compressed"};
+static const char* order_names[] = {"none", "degree", "rcm", "gorder"};
+
 typedef struct {
     char* filename;
     char* outfilename;
+    char* snapshot;
+    int snapshot_verify;
     int cyclesize;
     int directed;
     int twocore;
+    int kcore;
+    int lengthprune;
+    int contract;
+    int distprune;
+    int ego;
+    int stream;
+    int backend;
+    int threads;
+    int order;
+    int estimate;
+    double max_memory;
     int verbose;
     int config[MAX_CONFIG];
     int config_len;
 } ProgramOptions;
 
+// Prints the command line syntax with every option
+void print_usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s <graph_file> <cyclesize> [options]\n"
+            "  -d true|false                         directed graph\n"
+            "  -c int1 int2 [int3 int4]              join configuration\n"
+            "  -o [file]                             write the cycles to a file\n"
+            "  -v                                    verbose output\n"
+            "  -twocore true|false                   prune to the 2-core (default true)\n"
+            "  -kcore int                            restrict the search to the k-core\n"
+            "  -lengthprune true|false               remove edges on no cycle of this length\n"
+            "  -contract true|false                  contract chains of degree-2 vertices\n"
+            "  -distprune true|false                 prune paths too far from their start\n"
+            "  -ego true|false                       search the ego network of one anchor at a time\n"
+            "  -stream true|false                    build and join the paths of one anchor at a time\n"
+            "  -threads int                          number of worker threads\n"
+            "  -backend auto|csr|bitset|compressed   adjacency representation\n"
+            "  -order none|degree|rcm|gorder         vertex renumbering\n"
+            "  -estimate                             print estimated counts, memory and time, then exit\n"
+            "  -max-memory size                      memory budget, e.g. 512M or 16G\n"
+            "  -snapshot file                        binary snapshot of the parsed graph\n"
+            "  -snapshot-verify true|false           check the whole snapshot when loading it\n",
+            program);
+}
+
 // Parses command line arguments into ProgramOptions struct
 int parse_arguments(int argc, char* argv[], ProgramOptions* opts) {
     if (argc < 3) {
-        fprintf(stderr, "Usage: %s <graph_file> <cyclesize> [-d true|false] [-v true|false] [-c int1 int2 int3 int4]\n", argv[0]);
+        print_usage(argv[0]);
         return 0;
     }
 
@@ -60,9 +111,22 @@ int parse_arguments(int argc, char* argv[], ProgramOptions* opts) {
 
     opts->directed = 0;
     opts->twocore = 1;
+    opts->kcore = 0;
+    opts->lengthprune = 0;
+    opts->contract = 0;
+    opts->distprune = 0;
+    opts->ego = 0;
+    opts->stream = 0;
+    opts->backend = -1;
+    opts->threads = parallel_default_threads();
+    opts->order = ORDER_NONE;
+    opts->estimate = 0;
+    opts->max_memory = 0;
     opts->verbose = 0;
     opts->config_len = 0;
     opts->outfilename = NULL;
+    opts->snapshot = NULL;
+    opts->snapshot_verify = 0;
 
     // Optional arguments
     for (int i = 3; i < argc; i++) {
@@ -95,6 +159,160 @@ int parse_arguments(int argc, char* argv[], ProgramOptions* opts) {
                 return 0;
             }
             i++;
+        } else if (strcmp(argv[i], "-kcore") == 0) {
+            // Restrict the search to the k-core
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for -kcore\n");
+                return 0;
+            }
+            opts->kcore = atoi(argv[i + 1]);
+            if (opts->kcore <= 0) {
+                fprintf(stderr, "Invalid value for -kcore (expected a positive integer): %s\n", argv[i + 1]);
+                return 0;
+            }
+            i++;
+        } else if (strcmp(argv[i], "-lengthprune") == 0) {
+            // Drop edges too far apart to close a cycle of the requested length
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for -lengthprune\n");
+                return 0;
+            }
+            opts->lengthprune = strcmp(argv[i + 1], "true") == 0 ? 1 :
+                                strcmp(argv[i + 1], "false") == 0 ? 0 : -1;
+            if (opts->lengthprune == -1) {
+                fprintf(stderr, "Invalid value for -lengthprune (expected true/false): %s\n", argv[i + 1]);
+                return 0;
+            }
+            i++;
+        } else if (strcmp(argv[i], "-contract") == 0) {
+            // Enumerate on the graph with its degree-2 chains contracted
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for -contract\n");
+                return 0;
+            }
+            opts->contract = strcmp(argv[i + 1], "true") == 0 ? 1 :
+                             strcmp(argv[i + 1], "false") == 0 ? 0 : -1;
+            if (opts->contract == -1) {
+                fprintf(stderr, "Invalid value for -contract (expected true/false): %s\n", argv[i + 1]);
+                return 0;
+            }
+            i++;
+        } else if (strcmp(argv[i], "-distprune") == 0) {
+            // Stop paths that stray too far from their start to close a cycle
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for -distprune\n");
+                return 0;
+            }
+            opts->distprune = strcmp(argv[i + 1], "true") == 0 ? 1 :
+                              strcmp(argv[i + 1], "false") == 0 ? 0 : -1;
+            if (opts->distprune == -1) {
+                fprintf(stderr, "Invalid value for -distprune (expected true/false): %s\n", argv[i + 1]);
+                return 0;
+            }
+            i++;
+        } else if (strcmp(argv[i], "-ego") == 0) {
+            // Search the ego network of one anchor vertex at a time
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for -ego\n");
+                return 0;
+            }
+            opts->ego = strcmp(argv[i + 1], "true") == 0 ? 1 :
+                        strcmp(argv[i + 1], "false") == 0 ? 0 : -1;
+            if (opts->ego == -1) {
+                fprintf(stderr, "Invalid value for -ego (expected true/false): %s\n", argv[i + 1]);
+                return 0;
+            }
+            i++;
+        } else if (strcmp(argv[i], "-stream") == 0) {
+            // Enumerate and join the paths of one anchor vertex at a time
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for -stream\n");
+                return 0;
+            }
+            opts->stream = strcmp(argv[i + 1], "true") == 0 ? 1 :
+                           strcmp(argv[i + 1], "false") == 0 ? 0 : -1;
+            if (opts->stream == -1) {
+                fprintf(stderr, "Invalid value for -stream (expected true/false): %s\n", argv[i + 1]);
+                return 0;
+            }
+            i++;
+        } else if (strcmp(argv[i], "-backend") == 0) {
+            // Adjacency backend, picked from graph density when "auto"
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for -backend\n");
+                return 0;
+            }
+            opts->backend = strcmp(argv[i + 1], "auto") == 0 ? -1 :
+                            strcmp(argv[i + 1], "csr") == 0 ? GRAPH_CSR :
+                            strcmp(argv[i + 1], "bitset") == 0 ? GRAPH_BITSET :
+                            strcmp(argv[i + 1], "compressed") == 0 ? GRAPH_COMPRESSED : -2;
+            if (opts->backend == -2) {
+                fprintf(stderr, "Invalid value for -backend (expected auto/csr/bitset/compressed): %s\n", argv[i + 1]);
+                return 0;
+            }
+            i++;
+        } else if (strcmp(argv[i], "-threads") == 0) {
+            // Number of worker threads
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for -threads\n");
+                return 0;
+            }
+            opts->threads = atoi(argv[i + 1]);
+            if (opts->threads <= 0) {
+                fprintf(stderr, "Invalid value for -threads (expected a positive integer): %s\n", argv[i + 1]);
+                return 0;
+            }
+            i++;
+        } else if (strcmp(argv[i], "-order") == 0) {
+            // Vertex ordering applied after loading
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for -order\n");
+                return 0;
+            }
+            opts->order = strcmp(argv[i + 1], "none") == 0 ? ORDER_NONE :
+                          strcmp(argv[i + 1], "degree") == 0 ? ORDER_DEGREE :
+                          strcmp(argv[i + 1], "rcm") == 0 ? ORDER_RCM :
+                          strcmp(argv[i + 1], "gorder") == 0 ? ORDER_GORDER : -1;
+            if (opts->order == -1) {
+                fprintf(stderr, "Invalid value for -order (expected none/degree/rcm/gorder): %s\n", argv[i + 1]);
+                return 0;
+            }
+            i++;
+        } else if (strcmp(argv[i], "-estimate") == 0) {
+            // Only print the estimated path counts and memory
+            opts->estimate = 1;
+        } else if (strcmp(argv[i], "-max-memory") == 0) {
+            // Memory budget checked before enumeration
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for -max-memory\n");
+                return 0;
+            }
+            if (!parse_memory_size(argv[i + 1], &opts->max_memory)) {
+                fprintf(stderr, "Invalid value for -max-memory (expected a size such as 512M or 16G): %s\n", argv[i + 1]);
+                return 0;
+            }
+            i++;
+        } else if (strcmp(argv[i], "-snapshot") == 0) {
+            // Binary snapshot used as a cache of the parsed (and pruned) graph
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for -snapshot\n");
+                return 0;
+            }
+            opts->snapshot = argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "-snapshot-verify") == 0) {
+            // Check the payload checksum of a loaded snapshot
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing value for -snapshot-verify\n");
+                return 0;
+            }
+            opts->snapshot_verify = strcmp(argv[i + 1], "true") == 0 ? 1 :
+                                    strcmp(argv[i + 1], "false") == 0 ? 0 : -1;
+            if (opts->snapshot_verify == -1) {
+                fprintf(stderr, "Invalid value for -snapshot-verify (expected true/false): %s\n", argv[i + 1]);
+                return 0;
+            }
+            i++;
         } else if (strcmp(argv[i], "-c") == 0) {
             // Path configuration values
             int j = 0;
@@ -151,6 +369,7 @@ int parse_arguments(int argc, char* argv[], ProgramOptions* opts) {
         } else {
             // Unknown flag
             fprintf(stderr, "Unknown option or misplaced argument: %s\n", argv[i]);
+            print_usage(argv[0]);
             return 0;
         }
     }
@@ -179,26 +398,211 @@ void write_cycles_to_file(const char* filename, CycleSetEntry* cycles, int cycle
     fclose(out);
 }
 
-// Prepares path structures used for cycle construction based on config
-PathMapEntry** get_path_configs(ProgramOptions* opts, int** adj, int* degrees, int num_vertices, int* unique_count_ptr, PathMapEntry*** unique_paths) {
-    int path_sizes[MAX_CONFIG];
-    PathMapEntry* paths[MAX_CONFIG] = {NULL};
-    int unique_count = 0;
+// Splits the cycle size into parts path lengths that differ by at most one,
+// the longer ones last
+void balanced_config(int cyclesize, int parts, int* config) {
+    for (int i = 0; i < parts; i++) {
+        config[i] = cyclesize / parts + (i >= parts - cyclesize % parts ? 1 : 0);
+    }
+}
 
-    // Default config if none provided
-    if (opts->config_len == 0) {
-        int half = opts->cyclesize / 2;
+// Estimated memory of the path maps of a join configuration; adds the time to
+// build them to *seconds
+double config_bytes(const int* config, int config_len, const CountEstimate* paths, double* seconds) {
+    double bytes = 0;
+    for (int i = 0; i < config_len; i++) {
+        int repeated = 0;
+        for (int j = 0; j < i; j++) repeated |= config[j] == config[i];
+        if (!repeated) {
+            bytes += path_map_bytes(&paths[config[i]], config[i]);
+            *seconds += path_seconds(&paths[config[i]]);
+        }
+    }
+    return bytes;
+}
+
+// Estimated memory of the path maps one -stream anchor holds at a time: the
+// first and the last map hold the paths of the anchor, every inner one those
+// of the ends of the previous map. Adds the time to build the maps of all
+// anchors to *seconds
+double anchor_config_bytes(const int* config, int config_len, const CountEstimate* paths, double* seconds) {
+    double starts = paths[0].count, reach = 1, bytes = 0;
+    if (starts <= 0) return 0;
+    for (int i = 0; i < config_len; i++) {
+        const CountEstimate* est = &paths[config[i]];
+        double from = i == 0 || i == config_len - 1 ? 1 : reach;
+        CountEstimate share = {est->count * from / starts, 0, est->keys * from / starts, est->steps * from / starts};
+        bytes += path_map_bytes(&share, config[i]);
+        *seconds += starts * path_seconds(&share);
+        reach = share.keys < starts ? share.keys : starts;
+    }
+    return bytes;
+}
+
+// Estimated memory of the ego network one -ego anchor holds at a time and of
+// its two path maps, which hold the paths of the anchor alone. Adds the time
+// to build the maps of all anchors to *seconds
+double ego_anchor_bytes(const Graph* g, const int* config, const CountEstimate* paths, double* seconds) {
+    double starts = paths[0].count;
+    if (starts <= 0) return 0;
+
+    // Every vertex at distance d ends a path of length d from the anchor
+    double ball = 1;
+    for (int d = 1; d <= (config[0] + config[1]) / 2; d++) ball += paths[d].keys / starts;
+    if (ball > starts) ball = starts;
+    int directions = g->directed ? 2 : 1;
+    double bytes = directions * ball * (sizeof(size_t) + g->m / starts * sizeof(int)) + 2 * ball * sizeof(int);
+
+    for (int i = 0; i < 2; i++) {
+        const CountEstimate* est = &paths[config[i]];
+        CountEstimate share = {est->count / starts, 0, est->keys / starts, est->steps / starts};
+        bytes += path_map_bytes(&share, config[i]);
+        *seconds += starts * path_seconds(&share);
+    }
+    return bytes;
+}
+
+// Prints a join configuration with its estimated memory and time
+void print_config_estimate(const int* config, int config_len, double bytes, double seconds, const char* note) {
+    printf("  %d-join [", config_len);
+    for (int i = 0; i < config_len; i++) printf("%s%d", i ? " " : "", config[i]);
+    printf("]%s: %.1f MiB, ~%.2f s\n", note, bytes / (1024.0 * 1024.0), seconds);
+}
+
+// Estimates path counts and memory of the mode that will run before anything
+// is enumerated; -ego and -stream hold the maps of one anchor per thread at a
+// time. Prints them with -estimate. With -max-memory, a global join that does
+// not fit switches to the fastest of -stream and, unless the join was given
+// with -c, the 3- and 4-joins over shorter paths that fits. Returns 0 if the
+// run must stop, with *status set to its exit code.
+int check_memory(ProgramOptions* opts, const Graph* g, int* status) {
+    *status = 0;
+    if (!opts->estimate && opts->max_memory <= 0) return 1;
+
+    int pinned = opts->config_len > 0;
+    if (!pinned) {
         opts->config_len = 2;
-        opts->config[0] = half;
+        balanced_config(opts->cyclesize, opts->config_len, opts->config);
+    }
 
-        if (opts->cyclesize % 2 == 0) {
-            opts->config[1] = half;
-        } else {
-            opts->config[1] = half + 1;
+    int max_len = (opts->cyclesize + 1) / 2;
+    for (int i = 0; i < opts->config_len; i++) {
+        if (opts->config[i] > max_len) max_len = opts->config[i];
+    }
+
+    CountEstimate* paths = malloc((max_len + 1) * sizeof(CountEstimate));
+    CountEstimate cycles;
+    if (!paths || !estimate_counts(g, max_len, opts->cyclesize, ESTIMATE_SAMPLES, paths, &cycles)) {
+        fprintf(stderr, "Memory allocation failed for estimation\n");
+        free(paths);
+        *status = 1;
+        return 0;
+    }
+
+    // The adjacency and the cycle set are needed whatever the join
+    double fixed = graph_adjacency_bytes(g) + cycle_set_bytes(&cycles, opts->cyclesize);
+    double seconds = join_seconds(g, opts->config, opts->config_len, paths, &cycles, opts->cyclesize);
+
+    // Every thread of -ego and -stream holds one anchor and its scratch arrays
+    double threads = opts->threads < paths[0].count ? opts->threads : paths[0].count;
+    double stream_seconds = seconds;
+    double stream_bytes = fixed + threads * ((double)g->n * sizeof(int) + g->n / 8 +
+                          anchor_config_bytes(opts->config, opts->config_len, paths, &stream_seconds));
+
+    double need;
+    const char* mode = "";
+    if (opts->contract) {
+        // The contracted graph is only known once the chains are contracted
+        need = fixed;
+        mode = " with -contract, paths not included";
+    } else if (opts->ego) {
+        need = fixed + threads * (4.0 * g->n * sizeof(int) + g->n / 8 +
+                                  ego_anchor_bytes(g, opts->config, paths, &seconds));
+        mode = " with -ego";
+    } else if (opts->stream) {
+        need = stream_bytes;
+        seconds = stream_seconds;
+        mode = " with -stream";
+    } else {
+        need = fixed + config_bytes(opts->config, opts->config_len, paths, &seconds);
+    }
+    int global = !opts->contract && !opts->ego && !opts->stream;
+
+    // Candidate joins over shorter paths; they need less memory but scan the
+    // path maps for every key, so they usually take much longer
+    int alternatives[2][MAX_CONFIG];
+    double alternative_bytes[2], alternative_seconds[2];
+    int alternative_count = 0;
+    for (int parts = 3; global && parts <= MAX_CONFIG && parts <= opts->cyclesize; parts++) {
+        int* config = alternatives[alternative_count];
+        balanced_config(opts->cyclesize, parts, config);
+        alternative_seconds[alternative_count] = join_seconds(g, config, parts, paths, &cycles, opts->cyclesize);
+        alternative_bytes[alternative_count] = fixed + config_bytes(config, parts, paths, &alternative_seconds[alternative_count]);
+        alternative_count++;
+    }
+
+    if (opts->estimate) {
+        printf("Estimate for cycles of length %d (%d probes):\n", opts->cyclesize, ESTIMATE_SAMPLES);
+        for (int len = 1; len <= max_len; len++) {
+            double rel = paths[len].count > 0 ? 100.0 * paths[len].error / paths[len].count : 0;
+            printf("  paths of length %d: %.3g (+- %.1f%%), %.1f MiB, ~%.2f s\n", len, paths[len].count, rel,
+                   path_map_bytes(&paths[len], len) / (1024.0 * 1024.0), path_seconds(&paths[len]));
         }
+        double rel = cycles.count > 0 ? 100.0 * cycles.error / cycles.count : 0;
+        printf("  cycles of length %d: %.3g (+- %.1f%%), %.1f MiB\n", opts->cyclesize, cycles.count, rel,
+               cycle_set_bytes(&cycles, opts->cyclesize) / (1024.0 * 1024.0));
+        printf("  adjacency: %.1f MiB\n", graph_adjacency_bytes(g) / (1024.0 * 1024.0));
+        char note[64];
+        snprintf(note, sizeof(note), "%s (selected)", mode);
+        print_config_estimate(opts->config, opts->config_len, need, seconds, note);
+        if (global) print_config_estimate(opts->config, opts->config_len, stream_bytes, stream_seconds, " with -stream");
+        for (int a = 0; a < alternative_count; a++) {
+            print_config_estimate(alternatives[a], a + 3, alternative_bytes[a], alternative_seconds[a], "");
+        }
+        free(paths);
+        return 0;
+    }
+    free(paths);
+
+    if (need <= opts->max_memory) return 1;
+
+    // Switch to the fastest of -stream and the shorter-path joins that fits,
+    // the latter only if the join was not given with -c; otherwise report the
+    // smallest one
+    int best = -1, smallest = -1;
+    for (int a = 0; a < alternative_count; a++) {
+        if (smallest < 0 || alternative_bytes[a] < alternative_bytes[smallest]) smallest = a;
+        if (!pinned && alternative_bytes[a] <= opts->max_memory &&
+            (best < 0 || alternative_seconds[a] < alternative_seconds[best])) best = a;
+    }
+    if (global && stream_bytes <= opts->max_memory &&
+        (best < 0 || stream_seconds <= alternative_seconds[best])) {
+        fprintf(stderr, "Estimated memory %.1f MiB exceeds -max-memory, using -stream (%.1f MiB, ~%.0f s)\n",
+                need / (1024.0 * 1024.0), stream_bytes / (1024.0 * 1024.0), stream_seconds);
+        opts->stream = 1;
+        return 1;
+    }
+    if (best >= 0) {
+        fprintf(stderr, "Estimated memory %.1f MiB exceeds -max-memory, using a %d-join (%.1f MiB, ~%.0f s)\n",
+                need / (1024.0 * 1024.0), best + 3, alternative_bytes[best] / (1024.0 * 1024.0),
+                alternative_seconds[best]);
+        opts->config_len = best + 3;
+        memcpy(opts->config, alternatives[best], opts->config_len * sizeof(int));
+        return 1;
     }
 
-    // Identify unique path sizes to avoid recomputation
+    double least = need;
+    if (global && stream_bytes < least) least = stream_bytes;
+    if (!pinned && smallest >= 0 && alternative_bytes[smallest] < least) least = alternative_bytes[smallest];
+    fprintf(stderr, "Estimated memory %.1f MiB exceeds -max-memory %.1f MiB\n",
+            least / (1024.0 * 1024.0), opts->max_memory / (1024.0 * 1024.0));
+    *status = 1;
+    return 0;
+}
+
+// Collects the distinct path lengths of the join configuration, in config order
+int unique_path_sizes(const ProgramOptions* opts, int* path_sizes) {
+    int unique_count = 0;
     for (int i = 0; i < opts->config_len; i++) {
         int found = 0;
         for (int j = 0; j < unique_count; j++) {
@@ -207,31 +611,33 @@ PathMapEntry** get_path_configs(ProgramOptions* opts, int** adj, int* degrees, i
                 break;
             }
         }
-        if (!found) {
-            int path_count = 0;
-            path_sizes[unique_count] = opts->config[i];
-            paths[unique_count] = get_paths(adj, degrees, num_vertices, path_sizes[unique_count], &path_count);
+        if (!found) path_sizes[unique_count++] = opts->config[i];
+    }
+    return unique_count;
+}
 
-            if (opts->verbose) {
-                printf("Paths of length %d found: %d\n", path_sizes[unique_count], path_count);
-            } else {
-                printf("%d, ", path_count);
-            }
+// Prepares path structures used for cycle construction based on config.
+// path_counts receives the number of paths of every unique path length.
+PathMap** get_path_configs(const ProgramOptions* opts, const Graph* g, int* path_counts, int* unique_count_ptr, PathMap*** unique_paths) {
+    int path_sizes[MAX_CONFIG];
+    PathMap* paths[MAX_CONFIG] = {NULL};
 
-            unique_count++;
-        }
+    // Enumerate each unique path size only once
+    int unique_count = unique_path_sizes(opts, path_sizes);
+    int found_all = 1;
+    for (int i = 0; i < unique_count; i++) {
+        paths[i] = get_paths(g, path_sizes[i], opts->distprune ? opts->cyclesize : 0, &path_counts[i]);
+        if (!paths[i]) found_all = 0;
     }
 
     // Map config to corresponding path entries
-    PathMapEntry** config_paths = malloc(sizeof(PathMapEntry*) * opts->config_len);
-    if (!config_paths) {
+    PathMap** config_paths = malloc(sizeof(PathMap*) * opts->config_len);
+    *unique_paths = malloc(sizeof(PathMap*) * MAX_CONFIG);
+    if (!found_all || !config_paths || !(*unique_paths)) {
         fprintf(stderr, "Memory allocation failed for config_paths\n");
-        return NULL;
-    }
-
-    *unique_paths = malloc(sizeof(PathMapEntry*) * MAX_CONFIG);
-    if (!(*unique_paths)) {
-        fprintf(stderr, "Memory allocation failed for unique_paths\n");
+        for (int i = 0; i < unique_count; i++) free_path_map(paths[i]);
+        free(config_paths);
+        free(*unique_paths);
         return NULL;
     }
 
@@ -253,92 +659,487 @@ PathMapEntry** get_path_configs(ProgramOptions* opts, int** adj, int* degrees, i
 }
 
 // Calls appropriate path joining function based on config length
-CycleSetEntry* run_path_join(PathMapEntry** config_paths, ProgramOptions* opts, int num_vertices, int *cycle_count) {
+CycleSetEntry* run_path_join(PathMap** config_paths, const ProgramOptions* opts, int num_vertices, JoinMode mode, int verbose, int *cycle_count) {
     int config_len = opts->config_len;
-    int verbose = opts->verbose;
-    int *config = opts->config;
+    const int *config = opts->config;
 
     if (config_len == 2) {
         return path_join(config_paths[0], config[0],
                          config_paths[1], config[1],
-                         num_vertices, cycle_count, verbose);
+                         num_vertices, mode, cycle_count, verbose);
     } else if (config_len == 3) {
         return path_join_three(config_paths[0], config[0],
                                config_paths[1], config[1],
                                config_paths[2], config[2],
-                               num_vertices, cycle_count, verbose);
+                               num_vertices, mode, cycle_count, verbose);
     } else if (config_len == 4) {
         return path_join_four(config_paths[0], config[0],
                               config_paths[1], config[1],
                               config_paths[2], config[2],
                               config_paths[3], config[3],
-                              num_vertices, cycle_count, verbose);
+                              num_vertices, mode, cycle_count, verbose);
     } else {
         fprintf(stderr, "Unsupported config length: %d\n", config_len);
         return NULL;
     }
 }
 
+// Counts and cycles of one thread of the anchor pipeline
+typedef struct {
+    int path_counts[MAX_CONFIG];
+    int cycle_count;
+    CycleSetEntry *cycles;
+    int ok;
+} AnchorResult;
+
+// Shared state of the threads running the anchor pipeline
+typedef struct {
+    const ProgramOptions *opts;
+    const Graph *graph;
+    AnchorResult *results;
+} AnchorRun;
+
+// Builds the path maps of the cycles whose lowest vertex is the anchor and
+// joins them: the first path leaves the anchor, every further one starts
+// where a path of the previous map ends, and the last returns to the anchor,
+// found from it against the arcs. No path visits a vertex below the anchor.
+// started holds the stamp of the starts already searched.
+static void join_anchor(const ProgramOptions *opts, const Graph *g, int anchor, PathSearch *search,
+                        int *started, int *stamp, AnchorResult *res) {
+    int last = opts->config_len - 1;
+    PathMap *maps[MAX_CONFIG] = {NULL};
+    int counts[MAX_CONFIG] = {0};
+
+    int ok = 1;
+    for (int i = 0; i <= last; i++) {
+        maps[i] = path_map_new(opts->config[i]);
+        if (!maps[i]) ok = 0;
+    }
+
+    if (ok) ok = add_paths_from(g, search, anchor, anchor, maps[0], &counts[0]);
+    for (int i = 1; i < last && ok && maps[i - 1]->count; i++) {
+        (*stamp)++;
+        for (int e = 0; e < maps[i - 1]->key_count; e++) {
+            int b = maps[i - 1]->entries[e].key.end;
+            if (started[b] == *stamp) continue;
+            started[b] = *stamp;
+            if (!add_paths_from(g, search, b, anchor, maps[i], &counts[i])) ok = 0;
+        }
+    }
+    if (ok && maps[last - 1]->count) {
+        Graph back = g->directed ? graph_transposed(g) : *g;
+        ok = add_paths_from(&back, search, anchor, anchor, maps[last], &counts[last]);
+        reverse_path_map(maps[last]);
+    }
+    // The 3- and 4-join scan the inner maps by start
+    int closed = ok && maps[last]->count;
+    for (int i = 1; i < last && closed; i++) closed = ok = path_map_index_starts(maps[i]);
+    if (!ok) res->ok = 0;
+
+    if (closed) {
+        int count;
+        JoinMode mode = g->directed ? JOIN_ANCHORED_DIRECTED : JOIN_ANCHORED;
+        CycleSetEntry *found = run_path_join(maps, opts, g->n, mode, 0, &count);
+        res->cycle_count += append_cycles(&res->cycles, found);
+    }
+
+    int path_sizes[MAX_CONFIG];
+    int unique_count = unique_path_sizes(opts, path_sizes);
+    for (int i = 0; i <= last; i++) {
+        for (int j = 0; j < unique_count; j++) {
+            if (path_sizes[j] == opts->config[i]) res->path_counts[j] += counts[i];
+        }
+        free_path_map(maps[i]);
+    }
+}
+
+// Runs the pipeline for the anchors of this thread, taken round-robin.
+static void anchor_task(void *ctx, int thread, int threads) {
+    AnchorRun *run = ctx;
+    const Graph *g = run->graph;
+    AnchorResult *res = &run->results[thread];
+
+    int *started = calloc(g->n ? g->n : 1, sizeof(int));
+    PathSearch *search = path_search_new(g->n, run->opts->cyclesize);
+    if (!started || !search) {
+        free(started);
+        path_search_free(search);
+        return;
+    }
+    res->ok = 1;
+
+    int stamp = 0;
+    for (int anchor = thread; anchor < g->n; anchor += threads) {
+        if (g->degrees[anchor] == 0) continue;
+        join_anchor(run->opts, g, anchor, search, started, &stamp, res);
+    }
+    free(started);
+    path_search_free(search);
+}
+
+// Enumerates the cycles one anchor vertex at a time, so only the paths of the
+// anchors in progress are held. The cycles are in the ids of g.
+int find_anchor_cycles(const ProgramOptions* opts, const Graph* g, int threads,
+                       int* path_counts, int* cycle_count, CycleSetEntry** cycles) {
+    if (threads > g->n) threads = g->n > 0 ? g->n : 1;
+    AnchorResult *results = calloc(threads, sizeof(AnchorResult));
+    if (!results) return 0;
+
+    AnchorRun run = {opts, g, results};
+    parallel_run(threads, anchor_task, &run);
+
+    int ok = 1;
+    *cycle_count = 0;
+    *cycles = NULL;
+    for (int t = 0; t < threads; t++) {
+        ok &= results[t].ok;
+        for (int i = 0; i < MAX_CONFIG; i++) path_counts[i] += results[t].path_counts[i];
+        *cycle_count += append_cycles(cycles, results[t].cycles);
+    }
+
+    free(results);
+    return ok;
+}
+
+// Enumerates the cycles of one graph. The cycles are returned in input ids.
+// With -contract, the contracted paths are counted as the first path length.
+// With -ego or -stream, the anchors are spread over the given number of threads.
+// Returns 0 on allocation failure.
+int find_cycles(const ProgramOptions* opts, const Graph* g, int verbose, int threads,
+                int* path_counts, int* cycle_count, CycleSetEntry** cycles) {
+    if (opts->ego && !opts->contract) {
+        return find_ego_cycles(g, opts->config[0], opts->config[1], threads, path_counts, cycle_count, cycles);
+    }
+    if (opts->stream && !opts->contract) {
+        if (!find_anchor_cycles(opts, g, threads, path_counts, cycle_count, cycles)) return 0;
+        if (g->orig_id) {
+            *cycles = relabel_cycles(*cycles, g->orig_id);
+        }
+        return 1;
+    }
+    if (opts->contract) {
+        if (!find_chain_cycles(g, opts->cyclesize, verbose, &path_counts[0], cycle_count, cycles)) return 0;
+        if (g->orig_id) {
+            *cycles = relabel_cycles(*cycles, g->orig_id);
+        }
+        return 1;
+    }
+
+    int unique_count = 0;
+    PathMap **unique_paths = NULL;
+    PathMap **config_paths = get_path_configs(opts, g, path_counts, &unique_count, &unique_paths);
+    if (!config_paths) return 0;
+
+    *cycles = run_path_join(config_paths, opts, g->n, JOIN_DEDUP, verbose, cycle_count);
+    if (g->orig_id) {
+        *cycles = relabel_cycles(*cycles, g->orig_id);
+    }
+
+    for (int i = 0; i < unique_count; i++) {
+        free_path_map(unique_paths[i]);
+    }
+    free(config_paths);
+    free(unique_paths);
+    return 1;
+}
+
+// Counts and cycles of one component of the graph
+typedef struct {
+    int vertices;
+    size_t arcs;
+    int path_counts[MAX_CONFIG];
+    int cycle_count;
+    CycleSetEntry *cycles;
+    CycleReject reject;
+    int ok;
+} GraphPart;
+
+// Shared state of the threads enumerating the components
+typedef struct {
+    const ProgramOptions *opts;
+    const Graph *graph;
+    const Components *components;
+    GraphPart *parts;
+} PartRun;
+
+// Builds every component as a graph of its own and enumerates its cycles.
+// Threads take the components round-robin, largest first.
+static void solve_parts_task(void *ctx, int thread, int threads) {
+    PartRun *run = ctx;
+    const Components *c = run->components;
+
+    int *rank = malloc((run->graph->n ? run->graph->n : 1) * sizeof(int));
+    if (!rank) return;
+    for (int v = 0; v < run->graph->n; v++) rank[v] = -1;
+
+    for (int i = thread; i < c->count; i += threads) {
+        GraphPart *part = &run->parts[i];
+        Graph *sub = graph_subgraph(run->graph, c->vertices + c->offsets[i],
+                                    c->offsets[i + 1] - c->offsets[i], rank);
+        if (!sub) continue;
+
+        part->vertices = sub->n;
+        part->arcs = sub->m;
+        part->reject = reject_cycle_length(sub, run->opts->cyclesize);
+        if (part->reject != CYCLES_POSSIBLE) {
+            part->ok = 1;
+            graph_free(sub);
+            continue;
+        }
+
+        if (run->opts->backend != -1) graph_use_backend(sub, (GraphBackend)run->opts->backend);
+        part->ok = find_cycles(run->opts, sub, 0, 1, part->path_counts, &part->cycle_count, &part->cycles);
+        graph_free(sub);
+    }
+
+    free(rank);
+}
+
+// Splits the graph into parts that each contain every cycle through their
+// vertices: the strongly connected components of a directed graph, or the
+// biconnected components of an undirected one. Arcs between parts and parts
+// with fewer vertices than the cycle are dropped. Returns 0 if the graph is
+// kept whole: it forms a single part or the split failed.
+int split_graph(const ProgramOptions* opts, const Graph* g, Components* components) {
+    if (g->directed) {
+        int *component = malloc((g->n ? g->n : 1) * sizeof(int));
+        if (!component) return 0;
+        int count = strong_components(g, component);
+        int ok = count >= 0 && group_components(component, g->n, count, opts->cyclesize, components);
+        free(component);
+        if (!ok) return 0;
+    } else if (!biconnected_components(g, opts->cyclesize, components)) {
+        return 0;
+    }
+
+    if (components->count == 1 && components->offsets[1] == g->n) {
+        free_components(components);
+        return 0;
+    }
+    return 1;
+}
+
+// Enumerates the cycles of every component on the worker threads and merges
+// the results. Returns 0 on allocation failure.
+int find_component_cycles(const ProgramOptions* opts, const Graph* g, const Components* components,
+                          int* path_counts, int* cycle_count, CycleSetEntry** cycles) {
+    GraphPart *parts = calloc(components->count ? components->count : 1, sizeof(GraphPart));
+    if (!parts) return 0;
+
+    PartRun run = {opts, g, components, parts};
+    int threads = opts->threads < components->count ? opts->threads : components->count;
+    parallel_run(threads, solve_parts_task, &run);
+
+    int path_sizes[MAX_CONFIG];
+    int unique_count = unique_path_sizes(opts, path_sizes);
+    int ok = 1;
+    *cycle_count = 0;
+    *cycles = NULL;
+    for (int i = 0; i < components->count; i++) {
+        GraphPart *part = &parts[i];
+        ok &= part->ok;
+        for (int j = 0; j < unique_count; j++) path_counts[j] += part->path_counts[j];
+        *cycle_count += merge_cycles(cycles, part->cycles);
+        if (opts->verbose && part->reject != CYCLES_POSSIBLE) {
+            printf("component %d: %d vertices, %zu arcs, skipped: %s\n",
+                   i, part->vertices, part->arcs, reject_reason(part->reject));
+        } else if (opts->verbose) {
+            printf("component %d: %d vertices, %zu arcs, %d cycles\n",
+                   i, part->vertices, part->arcs, part->cycle_count);
+        }
+    }
+
+    free(parts);
+    return ok;
+}
+
+// Loads the graph, pruned to the 2-core and by cycle length if requested.
+// The input may itself be a snapshot; with -snapshot, a matching snapshot is
+// used instead of parsing, and a missing or stale one is (re)written.
+Graph* load_graph(ProgramOptions* opts) {
+    Graph* graph = NULL;
+    int pruned = 0;
+
+    if (is_snapshot(opts->filename)) {
+        SnapshotStatus status = snapshot_load(opts->filename, NULL, opts->directed, opts->snapshot_verify, &graph, &pruned);
+        if (status == SNAPSHOT_STALE) {
+            fprintf(stderr, "Snapshot was built for a %s graph: %s\n", opts->directed ? "undirected" : "directed", opts->filename);
+            return NULL;
+        } else if (status != SNAPSHOT_OK) {
+            fprintf(stderr, "Invalid snapshot: %s\n", opts->filename);
+            return NULL;
+        }
+        if (opts->verbose) printf("Loaded snapshot: %s\n", opts->filename);
+    } else if (opts->snapshot) {
+        SnapshotStatus status = snapshot_load(opts->snapshot, opts->filename, opts->directed, opts->snapshot_verify, &graph, &pruned);
+        if (status == SNAPSHOT_OK && pruned != opts->twocore) {
+            free_graph(graph);
+            graph = NULL;
+            status = SNAPSHOT_STALE;
+        }
+        if (opts->verbose) {
+            printf("Snapshot %s: %s\n", opts->snapshot,
+                   status == SNAPSHOT_OK ? "loaded" :
+                   status == SNAPSHOT_MISSING ? "missing, building" :
+                   status == SNAPSHOT_STALE ? "stale, rebuilding" : "invalid, rebuilding");
+        }
+    }
+
+    if (!graph) {
+        // Parse graph file into CSR adjacency lists; degrees are filled while building them
+        graph = parse(opts->filename, opts->directed, opts->threads);
+        if (!graph) return NULL;
+
+        // Optional two-core optimisation
+        if (opts->twocore) {
+            pruned = twocores(graph) != NULL;
+            if (!pruned) fprintf(stderr, "Memory allocation failed for two-core pruning, keeping the full graph\n");
+        }
+
+        if (opts->snapshot && !snapshot_write(opts->snapshot, opts->filename, graph, pruned)) {
+            fprintf(stderr, "Warning: could not write snapshot '%s'\n", opts->snapshot);
+        }
+    } else if (opts->twocore && !pruned) {
+        if (!twocores(graph)) fprintf(stderr, "Memory allocation failed for two-core pruning, keeping the full graph\n");
+    }
+
+    // The k-core filter is not part of the snapshot
+    if (opts->kcore > 2 && !kcores(graph, opts->kcore)) {
+        fprintf(stderr, "Memory allocation failed for k-core pruning, keeping the full graph\n");
+    }
+
+    // Neither is the length pruning, which depends on the cycle length
+    if (opts->lengthprune) {
+        size_t removed;
+        if (!length_prune(graph, opts->cyclesize, opts->threads, &removed)) {
+            fprintf(stderr, "Memory allocation failed for length pruning, keeping the remaining edges\n");
+        }
+        if (opts->verbose) {
+            printf("Length pruning removed %zu %s\n", removed, opts->directed ? "arcs" : "edges");
+        }
+    }
+
+    return graph;
+}
+
 // Entry point of the program
 int main(int argc, char* argv[]) {
     ProgramOptions opts;
     if (!parse_arguments(argc, argv, &opts)) return 1;
 
 
-    // Load graph file
-    FILE *file = fopen(opts.filename, "r");
-    if (!file) {
-        perror("Error opening file");
+    // Load graph file or snapshot
+    Graph *graph = load_graph(&opts);
+    if (!graph) {
+        perror("Error during graph creation.\n");
         return 1;
     }
 
-    // Parse graph into adjacency matrix
-    int num_vertices = 0;
-    int **adj = parse(file, &num_vertices, opts.directed);
-    if (!adj) {
-        perror("Error during adj matrix creation.\n");
-        return 1;
+    // Renumber the remaining vertices densely (and for locality if requested);
+    // cycles are mapped back to input ids before output
+    if (!compact_graph(graph, (VertexOrder)opts.order)) {
+        fprintf(stderr, "Memory allocation failed for vertex compaction, keeping input ids\n");
     }
+    int num_vertices = graph->n;
 
-    // Compute vertex degrees
-    int *degrees = count_degrees(adj, num_vertices, opts.directed);
+    // Chains are only contracted in undirected graphs
+    if (opts.contract && (opts.directed || opts.cyclesize < 3)) {
+        fprintf(stderr, "-contract needs an undirected graph and a cycle length of at least 3, ignoring it\n");
+        opts.contract = 0;
+    }
 
-    // Optional two-core optimisation
-    if (opts.twocore) twocores(adj, degrees, num_vertices, opts.directed);
+    // The ego networks are searched with a 2-join through the anchor
+    if (opts.ego && !opts.contract && opts.config_len > 2) {
+        fprintf(stderr, "-ego joins two paths, ignoring the %d-join configuration\n", opts.config_len);
+        opts.config_len = 0;
+    }
 
-    // Get paths
-    int unique_count = 0;
-    PathMapEntry **unique_paths = NULL;
-    PathMapEntry **config_paths = get_path_configs(&opts, adj, degrees, num_vertices, &unique_count, &unique_paths);
+    // Check the estimated memory of the mode that runs before any path is stored
+    int status;
+    if (!check_memory(&opts, graph, &status)) {
+        free_graph(graph);
+        free(opts.outfilename);
+        return status;
+    }
+
+    // Default config if none provided
+    if (opts.config_len == 0) {
+        opts.config_len = 2;
+        balanced_config(opts.cyclesize, opts.config_len, opts.config);
+    }
 
+    // Cycles never leave a strongly connected component of a directed graph,
+    // nor a biconnected component of an undirected one
+    Components components = {0};
+    int split = split_graph(&opts, graph, &components);
+
+    // Skip the enumeration if the graph provably has no cycle of this length;
+    // components are checked one by one
+    CycleReject reject = split ? CYCLES_POSSIBLE : reject_cycle_length(graph, opts.cyclesize);
+
+    // Override the automatically picked adjacency backend if requested
+    if (!split && opts.backend != -1 && !graph_use_backend(graph, (GraphBackend)opts.backend)) {
+        fprintf(stderr, "Could not build %s adjacency, using csr\n", backend_names[opts.backend]);
+    }
 
     // Verbose output
     if (opts.verbose) {
         printf("filename: %s\n", opts.filename);
         printf("cyclesize: %d\n", opts.cyclesize);
         printf("directed: %s\n", opts.directed ? "true" : "false");
+        printf("vertices: %d\n", num_vertices);
+        printf("backend: %s\n", backend_names[graph->backend]);
+        printf("adjacency: %.1f MiB\n", graph_adjacency_bytes(graph) / (1024.0 * 1024.0));
+        printf("threads: %d\n", opts.threads);
+        printf("order: %s\n", order_names[opts.order]);
+        if (split) {
+            printf("%s components: %d\n", graph->directed ? "strongly connected" : "biconnected", components.count);
+        }
         printf("config (%d-join): [", opts.config_len);
         for (int i = 0; i < opts.config_len; i++) {
             printf(" - %d", opts.config[i]);
         }
         printf(" - ]\n");
+        if (reject != CYCLES_POSSIBLE) printf("skipped: %s\n", reject_reason(reject));
     }
 
-    // Find cycles via PathJoin
+    // Find cycles via PathJoin, per component if the graph was split
+    int path_counts[MAX_CONFIG] = {0};
     int cycle_count = 0;
-    CycleSetEntry*cycles = run_path_join(config_paths, &opts, num_vertices, &cycle_count);
-
-    if (!opts.verbose) {
-        printf("%d\n", cycle_count);
+    CycleSetEntry *cycles = NULL;
+    int found = split ? find_component_cycles(&opts, graph, &components, path_counts, &cycle_count, &cycles)
+              : reject != CYCLES_POSSIBLE ? 1
+              : find_cycles(&opts, graph, opts.verbose, opts.threads, path_counts, &cycle_count, &cycles);
+    free_components(&components);
+    if (!found) {
+        // Like a failed load, report nothing and exit with an error
+        fprintf(stderr, "Memory allocation failed during cycle enumeration\n");
+        status = 1;
     } else {
-        printf("\nCycles found: %d\n", cycle_count);
-    }
+        int path_sizes[MAX_CONFIG];
+        int unique_count = opts.contract ? 1 : unique_path_sizes(&opts, path_sizes);
+        for (int i = 0; i < unique_count; i++) {
+            if (opts.contract) {
+                printf(opts.verbose ? "\nContracted paths found: %d\n" : "%d, ", path_counts[i]);
+            } else if (opts.verbose) {
+                printf("%sPaths of length %d found: %d\n", i == 0 ? "\n" : "", path_sizes[i], path_counts[i]);
+            } else {
+                printf("%d, ", path_counts[i]);
+            }
+        }
+
+        if (!opts.verbose) {
+            printf("%d\n", cycle_count);
+        } else {
+            printf("Cycles found: %d\n", cycle_count);
+        }
 
-    // Write cycles to output file if specified
-    if (opts.outfilename != NULL) {
-        write_cycles_to_file(opts.outfilename, cycles, cycle_count, opts.cyclesize);
-        if (opts.verbose) {
-            printf("Cycles written to output file: %s\n", opts.outfilename);
+        // Write cycles to output file if specified
+        if (opts.outfilename != NULL) {
+            write_cycles_to_file(opts.outfilename, cycles, cycle_count, opts.cyclesize);
+            if (opts.verbose) {
+                printf("Cycles written to output file: %s\n", opts.outfilename);
+            }
         }
     }
 
@@ -350,20 +1151,13 @@ int main(int argc, char* argv[]) {
         free(centry);
     }
 
-    // Cleanup: free paths and path config.
-    for (int i = 0; i < unique_count; i++) {
-        free_path_map(unique_paths[i]);
-    }
-    free(config_paths);
-    free(unique_paths);
-
-    // Cleanup: free adjacency matrix
-    free_adjacency_matrix(adj, degrees, num_vertices);
+    // Cleanup: free graph
+    free_graph(graph);
 
     // Cleanup: free output filename memory
     if (opts.outfilename) {
         free(opts.outfilename);
     }
 
-    return 0;
+    return status;
 }
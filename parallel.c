@@ -0,0 +1,83 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Marco Blok
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// parallel.c
+#include "parallel.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+typedef struct {
+    ParallelTask task;
+    void *ctx;
+    int thread;
+    int threads;
+} Worker;
+
+static void* run_worker(void *arg) {
+    Worker *w = arg;
+    w->task(w->ctx, w->thread, w->threads);
+    return NULL;
+}
+
+// Uses the number of online processors as the default thread count.
+int parallel_default_threads(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+}
+
+// Spawns threads - 1 workers, runs index 0 on the caller and joins them all.
+void parallel_run(int threads, ParallelTask task, void *ctx) {
+    if (threads < 1) threads = 1;
+    if (threads == 1) {
+        task(ctx, 0, 1);
+        return;
+    }
+
+    pthread_t *ids = malloc(threads * sizeof(pthread_t));
+    Worker *workers = malloc(threads * sizeof(Worker));
+    char *started = calloc(threads, 1);
+    if (!ids || !workers || !started) {
+        // Fall back to running every share on the calling thread
+        for (int t = 0; t < threads; t++) task(ctx, t, threads);
+        free(ids);
+        free(workers);
+        free(started);
+        return;
+    }
+
+    for (int t = 1; t < threads; t++) {
+        workers[t] = (Worker){task, ctx, t, threads};
+        started[t] = pthread_create(&ids[t], NULL, run_worker, &workers[t]) == 0;
+    }
+    task(ctx, 0, threads);
+    for (int t = 1; t < threads; t++) {
+        if (started[t]) pthread_join(ids[t], NULL);
+        else task(ctx, t, threads);
+    }
+
+    free(ids);
+    free(workers);
+    free(started);
+}
@@ -0,0 +1,66 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Marco Blok
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// parallel.h
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stddef.h>
+
+/**
+ * @brief Work run on every thread of a parallel section.
+ *
+ * @param ctx       Shared context passed to parallel_run().
+ * @param thread    Index of the calling thread in [0, threads).
+ * @param threads   Total number of threads running the task.
+ */
+typedef void (*ParallelTask)(void *ctx, int thread, int threads);
+
+/**
+ * @brief Returns the number of online processors (at least 1).
+ */
+int parallel_default_threads(void);
+
+/**
+ * @brief Runs task on the given number of threads and waits for all of them.
+ *
+ * The calling thread runs index 0 itself. If a thread cannot be created its
+ * share is run on the calling thread, so the task always completes.
+ *
+ * @param threads   Number of threads to use (values below 1 are treated as 1).
+ * @param task      Function run once per thread index.
+ * @param ctx       Shared context passed to every call.
+ */
+void parallel_run(int threads, ParallelTask task, void *ctx);
+
+/**
+ * @brief Returns the start of the slice of [0, count) handled by thread t.
+ *
+ * Thread t handles [parallel_slice(count, t, threads), parallel_slice(count, t + 1, threads)).
+ */
+static inline size_t parallel_slice(size_t count, int t, int threads) {
+    return (size_t)((unsigned long long)count * (unsigned)t / (unsigned)threads);
+}
+
+#endif // PARALLEL_H
\ No newline at end of file
@@ -92,73 +92,153 @@ int cycle_already_seen(CycleSetEntry *set, int *cycle, int len) {
     return entry != NULL;
 }
 
-// Check if path is a simple cycle (start == end, no repeats)
-static int is_simple_cycle(int *path, int k, int *seen, int max_nodes) {
-    memset(seen, 0, max_nodes * sizeof(int));
+// Map every cycle to new ids and store it again in canonical form
+CycleSetEntry* relabel_cycles(CycleSetEntry *set, const int *ids) {
+    CycleSetEntry *relabelled = NULL;
+    CycleSetEntry *entry, *tmp;
+
+    HASH_ITER(hh, set, entry, tmp) {
+        HASH_DEL(set, entry);
+        for (int i = 0; i < entry->len; i++) {
+            entry->cycle[i] = ids[entry->cycle[i]];
+        }
+        int *canon = canonical_cycle(entry->cycle, entry->len - 1);
+        store_cycle(&relabelled, canon, entry->len);
+        free(entry->cycle);
+        free(entry);
+    }
+
+    return relabelled;
+}
+
+// Move the cycles of one set into another, skipping duplicates
+int merge_cycles(CycleSetEntry **set, CycleSetEntry *from) {
+    int added = 0;
+    CycleSetEntry *entry, *tmp;
+
+    HASH_ITER(hh, from, entry, tmp) {
+        HASH_DEL(from, entry);
+        if (cycle_already_seen(*set, entry->cycle, entry->len)) {
+            free(entry->cycle);
+            free(entry);
+            continue;
+        }
+        HASH_ADD_KEYPTR(hh, *set, entry->cycle, entry->len * sizeof(int), entry);
+        added++;
+    }
+
+    return added;
+}
 
+// Move the cycles of one set into another without looking them up
+int append_cycles(CycleSetEntry **set, CycleSetEntry *from) {
+    int added = 0;
+    CycleSetEntry *entry, *tmp;
+
+    HASH_ITER(hh, from, entry, tmp) {
+        HASH_DEL(from, entry);
+        HASH_ADD_KEYPTR(hh, *set, entry->cycle, entry->len * sizeof(int), entry);
+        added++;
+    }
+
+    return added;
+}
+
+// Check if path is a simple cycle (start == end, no repeats).
+// seen is an all-zero bitset on entry and is left all-zero on return,
+// so each check costs O(k) bit probes instead of clearing max_nodes entries.
+static int is_simple_cycle(int *path, int k, uint64_t *seen) {
     if (path[0] != path[k]) {
         return 0;
     }
 
-    for (int i = 0; i < k; i++) {
-        if (seen[path[i]]) return 0;
-        seen[path[i]] = 1;
+    int i;
+    int simple = 1;
+    for (i = 0; i < k; i++) {
+        if (bitset_test(seen, path[i])) {
+            simple = 0;
+            break;
+        }
+        bitset_set(seen, path[i]);
+    }
+
+    // Clear only the bits that were set
+    for (int j = 0; j < i; j++) {
+        bitset_clear(seen, path[j]);
     }
+    return simple;
+}
+
+// Stores the joined closed walk of k edges if it is a simple cycle that the
+// mode keeps. Returns 1 if it was stored.
+static int emit_cycle(CycleSetEntry **set, int *joined, int k, JoinMode mode, uint64_t *seen, int count, int verbose) {
+    // An anchored undirected cycle is reached once in each direction
+    if (mode == JOIN_ANCHORED && joined[1] > joined[k - 1]) return 0;
+
+    // Validate if joined path is simple cycle
+    if (!is_simple_cycle(joined, k, seen)) return 0;
+
+    int *canon;
+    if (mode == JOIN_DEDUP) {
+        canon = canonical_cycle(joined, k);
+
+        // Store unique cycles only
+        if (cycle_already_seen(*set, canon, k + 1)) {
+            free(canon);
+            return 0;
+        }
+    } else {
+        // The lowest vertex is already first; only the direction may differ
+        // from the canonical form
+        canon = malloc((k + 1) * sizeof(int));
+        memcpy(canon, joined, (k + 1) * sizeof(int));
+        if (canon[k - 1] < canon[1]) reverse_in_place(canon, k);
+    }
+
+    if (verbose) {
+        if (count % 1000 == 0) {
+            printf("\rEnumerating cycles in progress: %d", count);
+            fflush(stdout);
+        }
+    }
+    store_cycle(set, canon, k + 1);
     return 1;
 }
 
 // Join paths from two maps and find unique simple cycles
 CycleSetEntry* path_join(
-    PathMapEntry *map1, int k1,
-    PathMapEntry *map2, int k2,
+    const PathMap *map1, int k1,
+    const PathMap *map2, int k2,
     int max_nodes,
+    JoinMode mode,
     int *out_count,
     int verbose
 ) {
     int count = 0;
 
-    int *seen = calloc(max_nodes, sizeof(int));  // zeroed for cycle validation
+    uint64_t *seen = calloc(bitset_words(max_nodes), sizeof(uint64_t));  // zeroed for cycle validation
     CycleSetEntry *cycle_set = NULL;
 
     int total_len = k1 + k2 + 1;
     int *joined = malloc(total_len * sizeof(int));
 
-    PathMapEntry *entry1, *tmp1;
-    HASH_ITER(hh, map1, entry1, tmp1) {
+    for (int e1 = 0; e1 < map1->key_count; e1++) {
+        const PathMapEntry *entry1 = &map1->entries[e1];
         // Reverse key to match end of path1 with start of path2
-        PathKey key = {entry1->key.end, entry1->key.start};
-        PathMapEntry *entry2;
-        HASH_FIND(hh, map2, &key, sizeof(PathKey), entry2);
+        const PathMapEntry *entry2 = path_map_find(map2, entry1->key.end, entry1->key.start);
         if (!entry2) continue;
 
         for (int i = 0; i < entry1->count; i++) {
-            int *w1 = entry1->path_list[i];
+            const int *w1 = path_map_path(map1, entry1->first + i);
 
             for (int j = 0; j < entry2->count; j++) {
-                int *w2 = entry2->path_list[j];
+                const int *w2 = path_map_path(map2, entry2->first + j);
 
                 // Join: w1[0..k1] + w2[1..k2]
                 memcpy(joined, w1, (k1 + 1) * sizeof(int));
                 memcpy(joined + k1 + 1, w2 + 1, k2 * sizeof(int));
 
-                // Validate if joined path is simple cycle
-                if (is_simple_cycle(joined, total_len - 1, seen, max_nodes)) {
-                    int *canon = canonical_cycle(joined, total_len - 1);
-
-                    // Store unique cycles only
-                    if (!cycle_already_seen(cycle_set, canon, total_len)) {
-                        if (verbose) {
-                            if (count % 1000 == 0) {
-                                printf("\rEnumerating cycles in progress: %d", count);
-                                fflush(stdout);
-                            }
-                        }
-                        store_cycle(&cycle_set, canon, total_len);
-                        count++;
-                    } else {
-                        free(canon);
-                    }
-                }
+                count += emit_cycle(&cycle_set, joined, total_len - 1, mode, seen, count, verbose);
             }
         }
     }
@@ -172,72 +252,55 @@ CycleSetEntry* path_join(
 
 // Join paths from three maps to form simple cycles
 CycleSetEntry* path_join_three(
-    PathMapEntry *map1, int k1,
-    PathMapEntry *map2, int k2,
-    PathMapEntry *map3, int k3,
+    const PathMap *map1, int k1,
+    const PathMap *map2, int k2,
+    const PathMap *map3, int k3,
     int max_nodes,
+    JoinMode mode,
     int *out_count,
     int verbose
 ) {
     int count = 0;
 
-    int *seen = calloc(max_nodes, sizeof(int));  // zeroed for cycle validation
+    uint64_t *seen = calloc(bitset_words(max_nodes), sizeof(uint64_t));  // zeroed for cycle validation
     CycleSetEntry *cycle_set = NULL;
 
     int total_len = k1 + k2 + k3 + 1;
     int *joined = malloc((total_len) * sizeof(int));
 
-    PathMapEntry *entry1, *tmp1;
-    HASH_ITER(hh, map1, entry1, tmp1) {
+    for (int e1 = 0; e1 < map1->key_count; e1++) {
+        const PathMapEntry *entry1 = &map1->entries[e1];
         int a = entry1->key.start;
         int b = entry1->key.end;
 
-        // Iterate over map2 for paths starting at b
-        PathMapEntry *entry2, *tmp2;
-        HASH_ITER(hh, map2, entry2, tmp2) {
-            if (entry2->key.start != b) continue;
+        // Scan the keys of map2 starting at b
+        int first2;
+        int last2 = path_map_start_range(map2, b, &first2);
+        for (int e2 = first2; e2 < last2; e2++) {
+            const PathMapEntry *entry2 = &map2->entries[e2];
             int c = entry2->key.end;
 
             // Lookup map3 for path c -> a to complete the cycle
-            PathKey key3 = {c, a};
-            PathMapEntry *entry3 = NULL;
-            HASH_FIND(hh, map3, &key3, sizeof(PathKey), entry3);
+            const PathMapEntry *entry3 = path_map_find(map3, c, a);
             if (!entry3) continue;
 
             for (int i = 0; i < entry1->count; i++) {
-                int *w1 = entry1->path_list[i];
+                const int *w1 = path_map_path(map1, entry1->first + i);
 
                 for (int j = 0; j < entry2->count; j++) {
-                    int *w2 = entry2->path_list[j];
-                    if (w2 == w1) continue; // skip if same path pointer
+                    const int *w2 = path_map_path(map2, entry2->first + j);
+                    if (w2 == w1) continue; // skip if same path
 
                     for (int m = 0; m < entry3->count; m++) {
-                        int *w3 = entry3->path_list[m];
-                        if (w3 == w1 || w3 == w2) continue; // skip if same path pointer
+                        const int *w3 = path_map_path(map3, entry3->first + m);
+                        if (w3 == w1 || w3 == w2) continue; // skip if same path
 
                         // Join paths: w1[0..k1], w2[1..k2], w3[1..k3]
                         memcpy(joined, w1, (k1 + 1) * sizeof(int));
                         memcpy(joined + k1 + 1, w2 + 1, k2 * sizeof(int));
                         memcpy(joined + k1 + k2 + 1, w3 + 1, k3 * sizeof(int));
 
-                        // Validate simple cycle
-                        if (is_simple_cycle(joined, total_len - 1, seen, max_nodes)) {
-                            int *canon = canonical_cycle(joined, total_len - 1);
-
-                            // Store unique cycles only
-                            if (!cycle_already_seen(cycle_set, canon, total_len)) {
-                                if (verbose) {
-                                    if (count % 1000 == 0) {
-                                        printf("\rEnumerating cycles in progress: %d", count);
-                                        fflush(stdout);
-                                    }
-                                }
-                                store_cycle(&cycle_set, canon, total_len);
-                                count++;
-                            } else {
-                                free(canon);
-                            }
-                        }
+                        count += emit_cycle(&cycle_set, joined, total_len - 1, mode, seen, count, verbose);
                     }
                 }
             }
@@ -253,59 +316,60 @@ CycleSetEntry* path_join_three(
 
 // Join paths from four maps to form simple cycles
 CycleSetEntry* path_join_four(
-    PathMapEntry *map1, int k1,
-    PathMapEntry *map2, int k2,
-    PathMapEntry *map3, int k3,
-    PathMapEntry *map4, int k4,
+    const PathMap *map1, int k1,
+    const PathMap *map2, int k2,
+    const PathMap *map3, int k3,
+    const PathMap *map4, int k4,
     int max_nodes,
+    JoinMode mode,
     int *out_count,
     int verbose
 ) {
     int count = 0;
 
-    int *seen = calloc(max_nodes, sizeof(int));  // for is_simple_cycle
+    uint64_t *seen = calloc(bitset_words(max_nodes), sizeof(uint64_t));  // for is_simple_cycle
     CycleSetEntry *cycle_set = NULL;
 
     int total_len = k1 + k2 + k3 + k4 + 1;
     int *joined = malloc((total_len) * sizeof(int));
 
-    PathMapEntry *entry1, *tmp1;
-    HASH_ITER(hh, map1, entry1, tmp1) {
+    for (int e1 = 0; e1 < map1->key_count; e1++) {
+        const PathMapEntry *entry1 = &map1->entries[e1];
         int a = entry1->key.start;
         int b = entry1->key.end;
 
-        // Iterate over map2 where start == b
-        PathMapEntry *entry2, *tmp2;
-        HASH_ITER(hh, map2, entry2, tmp2) {
-            if (entry2->key.start != b) continue;
+        // Scan the keys of map2 starting at b
+        int first2;
+        int last2 = path_map_start_range(map2, b, &first2);
+        for (int e2 = first2; e2 < last2; e2++) {
+            const PathMapEntry *entry2 = &map2->entries[e2];
             int c = entry2->key.end;
 
-            // Iterate over map3 where start == c
-            PathMapEntry *entry3, *tmp3;
-            HASH_ITER(hh, map3, entry3, tmp3) {
-                if (entry3->key.start != c) continue;
+            // Scan the keys of map3 starting at c
+            int first3;
+            int last3 = path_map_start_range(map3, c, &first3);
+            for (int e3 = first3; e3 < last3; e3++) {
+                const PathMapEntry *entry3 = &map3->entries[e3];
                 int d = entry3->key.end;
 
                 // Lookup map4 for path d -> a to complete the cycle
-                PathKey key4 = {d, a};
-                PathMapEntry *entry4 = NULL;
-                HASH_FIND(hh, map4, &key4, sizeof(PathKey), entry4);
+                const PathMapEntry *entry4 = path_map_find(map4, d, a);
                 if (!entry4) continue;
 
                 for (int i = 0; i < entry1->count; i++) {
-                    int *w1 = entry1->path_list[i];
+                    const int *w1 = path_map_path(map1, entry1->first + i);
 
                     for (int j = 0; j < entry2->count; j++) {
-                        int *w2 = entry2->path_list[j];
-                        if (w2 == w1) continue; // skip if same path pointer
+                        const int *w2 = path_map_path(map2, entry2->first + j);
+                        if (w2 == w1) continue; // skip if same path
 
                         for (int m = 0; m < entry3->count; m++) {
-                            int *w3 = entry3->path_list[m];
-                            if (w3 == w1 || w3 == w2) continue; // skip if same path pointer
+                            const int *w3 = path_map_path(map3, entry3->first + m);
+                            if (w3 == w1 || w3 == w2) continue; // skip if same path
 
                             for (int n = 0; n < entry4->count; n++) {
-                                int *w4 = entry4->path_list[n];
-                                if (w4 == w1 || w4 == w2 || w4 == w3) continue; // skip if same path pointer
+                                const int *w4 = path_map_path(map4, entry4->first + n);
+                                if (w4 == w1 || w4 == w2 || w4 == w3) continue; // skip if same path
 
                                 // Join paths: w1[0..k1], w2[1..k2], w3[1..k3], w4[1..k4]
                                 memcpy(joined, w1, (k1 + 1) * sizeof(int));
@@ -313,24 +377,7 @@ CycleSetEntry* path_join_four(
                                 memcpy(joined + k1 + k2 + 1, w3 + 1, k3 * sizeof(int));
                                 memcpy(joined + k1 + k2 + k3 + 1, w4 + 1, k4 * sizeof(int));
 
-                                // Validate simple cycle
-                                if (is_simple_cycle(joined, total_len - 1, seen, max_nodes)) {
-                                    int *canon = canonical_cycle(joined, total_len - 1);
-
-                                    // Store unique cycles only
-                                    if (!cycle_already_seen(cycle_set, canon, total_len)) {
-                                        if (verbose) {
-                                            if (count % 1000 == 0) {
-                                                printf("\rEnumerating cycles in progress: %d", count);
-                                                fflush(stdout);
-                                            }
-                                        }
-                                        store_cycle(&cycle_set, canon, total_len);
-                                        count++;
-                                    } else {
-                                        free(canon);
-                                    }
-                                }
+                                count += emit_cycle(&cycle_set, joined, total_len - 1, mode, seen, count, verbose);
                             }
                         }
                     }
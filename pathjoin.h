@@ -41,6 +41,36 @@ typedef struct {
     UT_hash_handle hh;
 } CycleSetEntry;
 
+/**
+ * @brief How the joins may reach the same cycle more than once.
+ */
+typedef enum {
+    JOIN_DEDUP,             // Any rotation and direction; cycles are canonicalized and deduplicated
+    JOIN_ANCHORED,          // Undirected; the first path starts at the lowest vertex of every cycle
+                            // and each cycle is kept in one of its two directions only
+    JOIN_ANCHORED_DIRECTED  // Directed; the first path starts at the lowest vertex of every cycle,
+                            // which is therefore reached exactly once
+} JoinMode;
+
+/**
+ * @brief Returns the canonical form of a cycle: its lowest vertex first, in a fixed orientation.
+ *
+ * @param cycle Vertices of the cycle; only cycle[0 .. len) is read
+ * @param len Number of edges of the cycle
+ * @return Newly allocated array of len + 1 vertices, the first repeated at the end
+ */
+int* canonical_cycle(int *cycle, int len);
+
+/**
+ * @brief Returns non-zero if the canonical cycle of len entries is in the set.
+ */
+int cycle_already_seen(CycleSetEntry *set, int *cycle, int len);
+
+/**
+ * @brief Adds a canonical cycle of len entries to the set, which takes ownership of it.
+ */
+void store_cycle(CycleSetEntry **set, int *cycle, int len);
+
 /**
  * @brief Joins two path maps to enumerate simple cycles formed by concatenating paths.
  *
@@ -48,15 +78,17 @@ typedef struct {
  * @param k1 Length of paths in the first map (i.e., number of edges)
  * @param map2 Pointer to the second path map
  * @param k2 Length of paths in the second map
- * @param max_nodes Maximum number of nodes in the graph (used for visited array)
+ * @param max_nodes Maximum number of nodes in the graph (used for visited bitset)
+ * @param mode Whether the paths are anchored; anchored cycles are stored without canonicalization or lookup
  * @param out_count Pointer to an integer where the number of cycles found will be stored
  * @param verbose If non-zero, enables verbose output during enumeration
  * @return Pointer to a hash set of unique canonicalized cycles found
  */
 CycleSetEntry* path_join(
-    PathMapEntry *map1, int k1,
-    PathMapEntry *map2, int k2,
+    const PathMap *map1, int k1,
+    const PathMap *map2, int k2,
     int max_nodes,
+    JoinMode mode,
     int *out_count,
     int verbose
 );
@@ -64,22 +96,27 @@ CycleSetEntry* path_join(
 /**
  * @brief Joins three path maps to enumerate simple cycles formed by concatenating paths.
  *
+ * The keys of map2 following a path of map1 are scanned as one range, so
+ * map2 must be indexed by start (see path_map_index_starts()).
+ *
  * @param map1 Pointer to the first path map
  * @param k1 Length of paths in the first map
  * @param map2 Pointer to the second path map
  * @param k2 Length of paths in the second map
  * @param map3 Pointer to the third path map
  * @param k3 Length of paths in the third map
- * @param max_nodes Maximum number of nodes in the graph (used for visited array)
+ * @param max_nodes Maximum number of nodes in the graph (used for visited bitset)
+ * @param mode Whether the paths are anchored; anchored cycles are stored without canonicalization or lookup
  * @param out_count Pointer to an integer where the number of cycles found will be stored
  * @param verbose If non-zero, enables verbose output during enumeration
  * @return Pointer to a hash set of unique canonicalized cycles found
  */
 CycleSetEntry* path_join_three(
-    PathMapEntry *map1, int k1,
-    PathMapEntry *map2, int k2,
-    PathMapEntry *map3, int k3,
+    const PathMap *map1, int k1,
+    const PathMap *map2, int k2,
+    const PathMap *map3, int k3,
     int max_nodes,
+    JoinMode mode,
     int *out_count,
     int verbose
 );
@@ -87,6 +124,9 @@ CycleSetEntry* path_join_three(
 /**
  * @brief Joins four path maps to enumerate simple cycles formed by concatenating paths.
  *
+ * map2 and map3 are scanned by start and must be indexed by it (see
+ * path_map_index_starts()).
+ *
  * @param map1 Pointer to the first path map
  * @param k1 Length of paths in the first map
  * @param map2 Pointer to the second path map
@@ -95,19 +135,56 @@ CycleSetEntry* path_join_three(
  * @param k3 Length of paths in the third map
  * @param map4 Pointer to the fourth path map
  * @param k4 Length of paths in the fourth map
- * @param max_nodes Maximum number of nodes in the graph (used for visited array)
+ * @param max_nodes Maximum number of nodes in the graph (used for visited bitset)
+ * @param mode Whether the paths are anchored; anchored cycles are stored without canonicalization or lookup
  * @param out_count Pointer to an integer where the number of cycles found will be stored
  * @param verbose If non-zero, enables verbose output during enumeration
  * @return Pointer to a hash set of unique canonicalized cycles found
  */
 CycleSetEntry* path_join_four(
-    PathMapEntry *map1, int k1,
-    PathMapEntry *map2, int k2,
-    PathMapEntry *map3, int k3,
-    PathMapEntry *map4, int k4,
+    const PathMap *map1, int k1,
+    const PathMap *map2, int k2,
+    const PathMap *map3, int k3,
+    const PathMap *map4, int k4,
     int max_nodes,
+    JoinMode mode,
     int *out_count,
     int verbose
 );
 
+/**
+ * @brief Maps every cycle in the set to other vertex ids and re-canonicalizes it.
+ *
+ * Used to report cycles found on a relabelled graph in the ids of the input file.
+ *
+ * @param set Hash set of canonical cycles; consumed by the call
+ * @param ids Array mapping each vertex to its new id (must be injective)
+ * @return Pointer to the new hash set of canonical cycles
+ */
+CycleSetEntry* relabel_cycles(CycleSetEntry *set, const int *ids);
+
+/**
+ * @brief Moves every cycle of one set into another.
+ *
+ * Used to combine the cycles found in separate parts of the graph. Cycles
+ * already present in the target set are dropped.
+ *
+ * @param set Pointer to the hash set receiving the cycles
+ * @param from Hash set of canonical cycles; consumed by the call
+ * @return Number of cycles added to the set
+ */
+int merge_cycles(CycleSetEntry **set, CycleSetEntry *from);
+
+/**
+ * @brief Moves every cycle of one set into another without checking for duplicates.
+ *
+ * Used to combine cycle sets that are known to be disjoint, such as those of
+ * different anchors.
+ *
+ * @param set Pointer to the hash set receiving the cycles
+ * @param from Hash set of canonical cycles; consumed by the call
+ * @return Number of cycles added to the set
+ */
+int append_cycles(CycleSetEntry **set, CycleSetEntry *from);
+
 #endif // PATHJOIN_H
\ No newline at end of file
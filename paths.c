@@ -24,103 +24,479 @@
 
 // paths.c
 #include <stdlib.h>
+#include <string.h>
 #include "paths.h"
-#include "uthash.h"
-
-// Global count of found paths.
-int COUNT = 0;
-
-// Adds a new path to the hash map keyed by start and end vertices.
-// Resizes the path list array dynamically if needed.
-void add_path_to_map(PathMapEntry **map, int *path, int k) {
-    PathKey key = {path[0], path[k]};
-    PathMapEntry *entry = NULL;
-
-    // Find existing entry by key
-    HASH_FIND(hh, *map, &key, sizeof(PathKey), entry);
-
-    if (!entry) {
-        // Create new entry if not found
-        entry = malloc(sizeof(PathMapEntry));
-        entry->key = key;
-        entry->count = 0;
-        entry->capacity = 4;
-        entry->path_list = malloc(sizeof(int*) * entry->capacity);
-        HASH_ADD(hh, *map, key, sizeof(PathKey), entry);
-    }
-
-    // Resize path_list if needed
-    if (entry->count == entry->capacity) {
-        entry->capacity *= 2;
-        entry->path_list = realloc(entry->path_list, sizeof(int*) * entry->capacity);
-    }
-
-    // Add new path pointer
-    entry->path_list[entry->count++] = path;
-}
-
-// Recursive DFS to find all simple paths of length len starting from node.
-// Avoids revisiting nodes already in path, adds completed paths to map.
-static void dfs(int **adj, int n_vertices, int len, int node, int depth, int *path, PathMapEntry **map) {
-    if (depth == len) {
-        // Path complete, copy and add to map
-        int *path_copy = malloc((len + 1) * sizeof(int));
-        memcpy(path_copy, path, (len + 1) * sizeof(int));
-        add_path_to_map(map, path_copy, len);
-        COUNT++;
-        return;
-    }
-
-    // Explore neighbors
-    for (int neighbor = 0; neighbor < n_vertices; neighbor++) {
-        if (adj[node][neighbor]) {
-            // Check if neighbor already visited in path to avoid cycles
-            int visited = 0;
-            for (int i = 0; i <= depth; i++) {
-                if (path[i] == neighbor) {
-                    visited = 1;
-                    break;
-                }
-            }
-            if (visited) continue;
+#include "bitset.h"
+
+PathMap* path_map_new(int len) {
+    PathMap *map = calloc(1, sizeof(PathMap));
+    if (!map) return NULL;
+    map->len = len;
+    return map;
+}
+
+// Returns the slot of a new path at the end of the arena, adding a chunk
+// when the last one is full, or NULL on allocation failure.
+static int* path_map_push(PathMap *map) {
+    size_t first = (((size_t)1 << map->chunk_count) - 1) << PATH_CHUNK_BITS;
+    if (map->count == first) {
+        if (map->chunk_count == PATH_MAX_CHUNKS) return NULL;
+        size_t paths = (size_t)1 << (PATH_CHUNK_BITS + map->chunk_count);
+        int *chunk = malloc(paths * (map->len + 1) * sizeof(int));
+        if (!chunk) return NULL;
+        map->chunks[map->chunk_count++] = chunk;
+    }
+    return path_map_path(map, map->count++);
+}
+
+// Inserts the entry into the key table, which has a free slot.
+static void table_insert(PathMap *map, int entry) {
+    uint64_t key = path_key_pack(map->entries[entry].key.start, map->entries[entry].key.end);
+    size_t mask = ((size_t)1 << map->table_bits) - 1;
+    size_t slot = path_key_slot(key, map->table_bits);
+    while (map->table_keys[slot] != PATH_KEY_EMPTY) slot = (slot + 1) & mask;
+    map->table_keys[slot] = key;
+    map->table_entries[slot] = entry;
+}
+
+// Replaces the key table by one of 2^bits slots holding every entry.
+static int table_rebuild(PathMap *map, int bits) {
+    size_t slots = (size_t)1 << bits;
+    uint64_t *keys = malloc(slots * sizeof(uint64_t));
+    int *entries = malloc(slots * sizeof(int));
+    if (!keys || !entries) {
+        free(keys);
+        free(entries);
+        return 0;
+    }
+    free(map->table_keys);
+    free(map->table_entries);
+    map->table_keys = keys;
+    map->table_entries = entries;
+    map->table_bits = bits;
+    for (size_t slot = 0; slot < slots; slot++) keys[slot] = PATH_KEY_EMPTY;
+    for (int e = 0; e < map->key_count; e++) table_insert(map, e);
+    return 1;
+}
+
+// Returns the entry of the key, adding an empty one if there is none, or -1
+// on allocation failure.
+static int map_entry(PathMap *map, PathKey key) {
+    const PathMapEntry *found = path_map_find(map, key.start, key.end);
+    if (found) return (int)(found - map->entries);
 
-            // Continue DFS with neighbor
-            path[depth + 1] = neighbor;
-            dfs(adj, n_vertices, len, neighbor, depth + 1, path, map);
+    if (map->key_count == map->key_capacity) {
+        int capacity = map->key_capacity ? 2 * map->key_capacity : 16;
+        PathMapEntry *entries = realloc(map->entries, capacity * sizeof(PathMapEntry));
+        if (!entries) return -1;
+        map->entries = entries;
+        map->key_capacity = capacity;
+    }
+    int e = map->key_count++;
+    map->entries[e] = (PathMapEntry){key, SIZE_MAX, 0};
+
+    // Keep the table at most half full
+    if (2 * (size_t)map->key_count > ((size_t)1 << map->table_bits)) {
+        int bits = map->table_bits ? map->table_bits + 1 : 5;
+        if (!table_rebuild(map, bits)) {
+            map->key_count--;
+            return -1;
         }
+    } else {
+        table_insert(map, e);
+    }
+    return e;
+}
+
+// Makes sure the grouping buffer of the search holds count paths.
+static int reserve_group(PathSearch *s, size_t count) {
+    if (count <= s->group_capacity) return 1;
+    size_t capacity = s->group_capacity ? s->group_capacity : 64;
+    while (capacity < count) capacity *= 2;
+    int *paths = realloc(s->group_paths, capacity * (s->max_len + 1) * sizeof(int));
+    if (!paths) return 0;
+    s->group_paths = paths;
+    s->group_capacity = capacity;
+    return 1;
+}
+
+// Orders entries by start vertex, then end vertex.
+static int compare_entries(const void *a, const void *b) {
+    const PathKey *x = &((const PathMapEntry*)a)->key;
+    const PathKey *y = &((const PathMapEntry*)b)->key;
+    if (x->start != y->start) return x->start < y->start ? -1 : 1;
+    if (x->end != y->end) return x->end < y->end ? -1 : 1;
+    return 0;
+}
+
+// Empties the key table and inserts every entry again.
+static void table_refill(PathMap *map) {
+    size_t slots = (size_t)1 << map->table_bits;
+    for (size_t slot = 0; slot < slots; slot++) map->table_keys[slot] = PATH_KEY_EMPTY;
+    for (int e = 0; e < map->key_count; e++) table_insert(map, e);
+}
+
+// Files the paths from index from on, which all have the same start, under
+// their keys. The paths of a start are found with their ends interleaved, so
+// they are reordered by key, keys in order of first appearance and paths in
+// found order within a key, to give every key a range of indices.
+static int file_paths(PathMap *map, PathSearch *s, size_t from) {
+    size_t count = map->count - from;
+    int len = map->len, stride = len + 1;
+    int first_key = map->key_count;
+    if (!reserve_group(s, count)) return 0;
+
+    // Count the paths per key; the keys are often already grouped
+    int in_order = 1;
+    int previous = -1;
+    for (size_t i = 0; i < count; i++) {
+        int *path = path_map_path(map, from + i);
+        PathKey key = {path[0], path[len]};
+        int e = map_entry(map, key);
+        if (e < 0) return 0;
+        if (e != previous && map->entries[e].count > 0) in_order = 0;
+        map->entries[e].count++;
+        previous = e;
+    }
+
+    // Give every key its range, in order of first appearance
+    PathMapEntry *entries = map->entries;
+    size_t next = from;
+    for (int e = first_key; e < map->key_count; e++) {
+        entries[e].first = next;
+        next += entries[e].count;
+    }
+    if (in_order) return 1;
+
+    // Move the paths into their ranges
+    for (size_t i = 0; i < count; i++) {
+        memcpy(s->group_paths + i * stride, path_map_path(map, from + i), stride * sizeof(int));
+    }
+    for (int e = first_key; e < map->key_count; e++) entries[e].count = 0;
+    for (size_t i = 0; i < count; i++) {
+        const int *path = s->group_paths + i * stride;
+        PathMapEntry *entry = (PathMapEntry*)path_map_find(map, path[0], path[len]);
+        memcpy(path_map_path(map, entry->first + entry->count++), path, stride * sizeof(int));
+    }
+    return 1;
+}
+
+// Orders start ranges by start vertex.
+static int compare_start_ranges(const void *a, const void *b) {
+    int x = ((const PathStartRange*)a)->start, y = ((const PathStartRange*)b)->start;
+    return (x > y) - (x < y);
+}
+
+// Lists the runs of entries with the same start, sorted by start. Returns
+// the number of runs, or -1 on allocation failure.
+static int list_start_runs(PathMap *map) {
+    int runs = 0, sorted = 1;
+    for (int e = 0; e < map->key_count; e++) {
+        if (e > 0 && map->entries[e].key.start == map->entries[e - 1].key.start) continue;
+        if (e > 0 && map->entries[e].key.start < map->entries[e - 1].key.start) sorted = 0;
+        runs++;
+    }
+
+    PathStartRange *ranges = malloc((runs ? runs : 1) * sizeof(PathStartRange));
+    if (!ranges) return -1;
+    int r = -1;
+    for (int e = 0; e < map->key_count; e++) {
+        int start = map->entries[e].key.start;
+        if (r < 0 || ranges[r].start != start) ranges[++r] = (PathStartRange){start, e, e};
+        ranges[r].end = e + 1;
+    }
+    if (!sorted) qsort(ranges, runs, sizeof(PathStartRange), compare_start_ranges);
+
+    free(map->start_ranges);
+    map->start_ranges = ranges;
+    map->start_count = runs;
+    return runs;
+}
+
+int path_map_index_starts(PathMap *map) {
+    if (list_start_runs(map) < 0) return 0;
+
+    // A start with several runs needs the entries themselves sorted
+    for (int r = 1; r < map->start_count; r++) {
+        if (map->start_ranges[r].start != map->start_ranges[r - 1].start) continue;
+        qsort(map->entries, map->key_count, sizeof(PathMapEntry), compare_entries);
+        table_refill(map);
+        return list_start_runs(map) >= 0;
+    }
+    return 1;
+}
+
+// Distances back to the start of the paths, bounding how far they may stray
+typedef struct {
+    int cyclesize;      // Length of the cycles the paths are part of
+    int *dist;          // Arcs from a vertex back to the start, valid where seen == stamp
+    int *seen;
+    int stamp;
+    int *queue;
+} PathBound;
+
+// Appends the vertices with an arc to v (any neighbor if undirected) that are
+// not yet reached to the queue, at distance d.
+static int reach_back(const Graph *g, PathBound *b, int v, int d, int tail) {
+    int directed = g->directed;
+    if (g->backend == GRAPH_COMPRESSED) {
+        PackedRow row = graph_packed_row(g, v, directed);
+        int w;
+        while (packed_row_next(&row, &w)) {
+            if (b->seen[w] == b->stamp) continue;
+            b->seen[w] = b->stamp;
+            b->dist[w] = d;
+            b->queue[tail++] = w;
+        }
+        return tail;
+    }
+
+    const size_t *offsets = directed ? g->in_offsets : g->offsets;
+    const int *neighbors = directed ? g->in_neighbors : g->neighbors;
+    for (size_t e = offsets[v]; e < offsets[v + 1]; e++) {
+        int w = neighbors[e];
+        if (b->seen[w] == b->stamp) continue;
+        b->seen[w] = b->stamp;
+        b->dist[w] = d;
+        b->queue[tail++] = w;
     }
+    return tail;
+}
+
+// Breadth-first search from start against the arcs, up to cyclesize - 1 arcs:
+// no vertex further away can be on a path from start that closes a cycle.
+static void bound_from(const Graph *g, PathBound *b, int start) {
+    b->stamp++;
+    b->seen[start] = b->stamp;
+    b->dist[start] = 0;
+    b->queue[0] = start;
+    int head = 0, tail = 1;
+    while (head < tail) {
+        int v = b->queue[head++];
+        if (b->dist[v] + 1 >= b->cyclesize) break;
+        tail = reach_back(g, b, v, b->dist[v] + 1, tail);
+    }
+}
+
+// Returns non-zero if a path that reaches v after depth arcs can still be
+// closed into a cycle: the rest of the cycle is cyclesize - depth arcs long.
+static inline int within_bound(const PathBound *b, int v, int depth) {
+    return b->seen[v] == b->stamp && b->dist[v] <= b->cyclesize - depth;
+}
+
+// Position in the neighbors of one vertex on the path, for each backend
+typedef struct PathCursor {
+    size_t next, end;           // CSR: remaining range of the row
+    const uint64_t *row;        // Bitset: the row and the word being scanned
+    int word;
+    uint64_t bits;
+    PackedRow packed;           // Compressed: the row being decoded
+} PathCursor;
+
+PathSearch* path_search_new(int n, int max_len) {
+    PathSearch *s = malloc(sizeof(PathSearch));
+    if (!s) return NULL;
+    s->path = malloc((max_len + 1) * sizeof(int));
+    s->cursors = malloc((max_len + 1) * sizeof(PathCursor));
+    s->on_path = calloc(bitset_words(n ? n : 1), sizeof(uint64_t));
+    s->group_paths = NULL;
+    s->group_capacity = 0;
+    s->max_len = max_len;
+    if (!s->path || !s->cursors || !s->on_path) {
+        path_search_free(s);
+        return NULL;
+    }
+    return s;
+}
+
+void path_search_free(PathSearch *s) {
+    if (!s) return;
+    free(s->path);
+    free(s->cursors);
+    free(s->on_path);
+    free(s->group_paths);
+    free(s);
+}
+
+// Positions the cursor before the first neighbor of v.
+static inline void cursor_open(const Graph *g, PathCursor *c, int v) {
+    if (g->backend == GRAPH_BITSET) {
+        c->row = graph_bitset_row(g, v);
+        c->word = 0;
+        c->bits = c->row[0];
+    } else if (g->backend == GRAPH_COMPRESSED) {
+        c->packed = graph_packed_row(g, v, 0);
+    } else {
+        c->next = g->offsets[v];
+        c->end = g->offsets[v + 1];
+    }
+}
+
+// Moves the cursor to the next neighbor. Returns 0 when the row is exhausted.
+static inline int cursor_next(const Graph *g, PathCursor *c, int *w) {
+    if (g->backend == GRAPH_BITSET) {
+        // Scan the adjacency row a word at a time
+        while (!c->bits) {
+            if (++c->word == g->words) return 0;
+            c->bits = c->row[c->word];
+        }
+        *w = (c->word << 6) + __builtin_ctzll(c->bits);
+        c->bits &= c->bits - 1;
+        return 1;
+    }
+    if (g->backend == GRAPH_COMPRESSED) return packed_row_next(&c->packed, w);
+    if (c->next == c->end) return 0;
+    *w = g->neighbors[c->next++];
+    return 1;
+}
+
+// Depth-first search for all simple paths of length len from start, with an
+// explicit stack of row cursors. The vertices on the path are marked in
+// on_path, so a neighbor is tested in constant time; a path is only copied
+// when it is complete. Neighbors not above floor or, with a bound, too far
+// from the start to close the cycle are not entered.
+static int search_paths(const Graph *g, PathSearch *s, int start, int floor,
+                        const PathBound *bound, PathMap *map, int *count) {
+    int len = map->len;
+    int *path = s->path;
+    PathCursor *cursors = s->cursors;
+    uint64_t *on_path = s->on_path;
+    size_t from = map->count;
+
+    path[0] = start;
+    if (len == 0) {
+        int *slot = path_map_push(map);
+        if (!slot) return 0;
+        slot[0] = start;
+        (*count)++;
+        return file_paths(map, s, from);
+    }
+
+    bitset_set(on_path, start);
+    cursor_open(g, &cursors[0], start);
+    int depth = 0;
+    while (depth >= 0) {
+        int w;
+        if (!cursor_next(g, &cursors[depth], &w)) {
+            // Row exhausted, step back
+            bitset_clear(on_path, path[depth]);
+            depth--;
+            continue;
+        }
+        if (w <= floor || bitset_test(on_path, w)) continue;
+        if (bound && !within_bound(bound, w, depth + 1)) continue;
+
+        path[depth + 1] = w;
+        if (depth + 1 == len) {
+            // Path complete, copy it to the arena
+            int *slot = path_map_push(map);
+            if (!slot) {
+                // Leave the path marks clear for the next search
+                for (int i = 0; i <= depth; i++) bitset_clear(on_path, path[i]);
+                return 0;
+            }
+            memcpy(slot, path, (len + 1) * sizeof(int));
+            (*count)++;
+            continue;
+        }
+
+        bitset_set(on_path, w);
+        cursor_open(g, &cursors[++depth], w);
+    }
+
+    return file_paths(map, s, from);
 }
 
 // Finds all simple paths of length len in the graph.
-// Skips isolated vertices.
-// Returns a hash map of paths grouped by their start and end vertices.
-PathMapEntry* get_paths(int **adj, int *degrees, int n_vertices, int len, int *path_count) {
-    PathMapEntry *map = NULL;
-    int *path = malloc((len + 1) * sizeof(int));
+// Skips isolated vertices. With a cycle size, the distances back to every
+// start are computed before its paths are searched.
+// Returns the paths grouped by their start and end vertices.
+PathMap* get_paths(const Graph *g, int len, int cyclesize, int *path_count) {
+    int count = 0;
 
-    for (int start = 0; start < n_vertices; start++) {
-        if (degrees[start] == 0) continue; // Skip isolated vertices
-        path[0] = start;
-        dfs(adj, n_vertices, len, start, 0, path, &map);
+    int n = g->n;
+    PathMap *map = path_map_new(len);
+    PathSearch *search = path_search_new(n, len);
+    if (!map || !search) {
+        free_path_map(map);
+        path_search_free(search);
+        *path_count = 0;
+        return NULL;
     }
 
-    free(path);
-    *path_count = COUNT;
+    PathBound bound = {cyclesize, NULL, NULL, 0, NULL};
+    PathBound *use_bound = NULL;
+    if (cyclesize > 0) {
+        bound.dist = malloc((n ? n : 1) * sizeof(int));
+        bound.seen = calloc(n ? n : 1, sizeof(int));
+        bound.queue = malloc((n ? n : 1) * sizeof(int));
+        // Without the scratch arrays the paths are searched unbounded
+        if (bound.dist && bound.seen && bound.queue) use_bound = &bound;
+    }
+
+    for (int start = 0; start < n && map; start++) {
+        if (g->degrees[start] == 0) continue; // Skip isolated vertices
+        if (use_bound) bound_from(g, use_bound, start);
+        if (!search_paths(g, search, start, -1, use_bound, map, &count)) {
+            free_path_map(map);
+            map = NULL;
+        }
+    }
+
+    if (map && !path_map_index_starts(map)) {
+        free_path_map(map);
+        map = NULL;
+    }
 
-    // reset global COUNT
-    COUNT = 0;
+    free(bound.dist);
+    free(bound.seen);
+    free(bound.queue);
+    path_search_free(search);
+    *path_count = count;
 
     return map;
 }
 
-// Prints all stored paths in the hash map.
-void print_path_map(PathMapEntry *map, int len) {
-    PathMapEntry *entry, *tmp;
-    HASH_ITER(hh, map, entry, tmp) {
+// Searches the paths of one start only.
+int add_paths_from(const Graph *g, PathSearch *search, int start, int floor,
+                   PathMap *map, int *path_count) {
+    return search_paths(g, search, start, floor, NULL, map, path_count);
+}
+
+// Reverses every path in place and files it under the swapped key.
+void reverse_path_map(PathMap *map) {
+    int len = map->len;
+    for (size_t i = 0; i < map->count; i++) {
+        int *path = path_map_path(map, i);
+        for (int j = 0; j < len - j; j++) {
+            int t = path[j];
+            path[j] = path[len - j];
+            path[len - j] = t;
+        }
+    }
+
+    for (int e = 0; e < map->key_count; e++) {
+        PathKey key = map->entries[e].key;
+        map->entries[e].key = (PathKey){key.end, key.start};
+    }
+    // The table is kept, as reinserting every entry cannot fail
+    if (map->table_bits) table_refill(map);
+
+    // The entries are no longer grouped by start
+    free(map->start_ranges);
+    map->start_ranges = NULL;
+    map->start_count = 0;
+}
+
+// Prints all stored paths, grouped by key.
+void print_path_map(const PathMap *map) {
+    for (int e = 0; e < map->key_count; e++) {
+        const PathMapEntry *entry = &map->entries[e];
         printf("From %d to %d:\n", entry->key.start, entry->key.end);
         for (int i = 0; i < entry->count; i++) {
-            for (int j = 0; j <= len; j++) {
-                printf("%d ", entry->path_list[i][j]);
+            const int *path = path_map_path(map, entry->first + i);
+            for (int j = 0; j <= map->len; j++) {
+                printf("%d ", path[j]);
             }
             printf("\n");
         }
@@ -128,15 +504,13 @@ void print_path_map(PathMapEntry *map, int len) {
     }
 }
 
-// Frees all allocated memory for the path map and contained paths.
-void free_path_map(PathMapEntry *map) {
-    PathMapEntry *entry, *tmp;
-    HASH_ITER(hh, map, entry, tmp) {
-        for (int i = 0; i < entry->count; i++) {
-            free(entry->path_list[i]);
-        }
-        free(entry->path_list);
-        HASH_DEL(map, entry);
-        free(entry);
-    }
+// Frees the entries, the key table and the arena, a chunk at a time.
+void free_path_map(PathMap *map) {
+    if (!map) return;
+    free(map->entries);
+    free(map->table_keys);
+    free(map->table_entries);
+    free(map->start_ranges);
+    for (int c = 0; c < map->chunk_count; c++) free(map->chunks[c]);
+    free(map);
 }
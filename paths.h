@@ -27,7 +27,7 @@
 #define PATHS_H
 
 #include <stdio.h>
-#include "uthash.h"
+#include "graph.h"
 
 /**
  * @brief Key to identify paths by their start and end vertices.
@@ -37,43 +37,239 @@ typedef struct {
 } PathKey;
 
 /**
- * @brief Structure for storing multiple paths between two vertices.
- *
- * Uses uthash for quick lookup by PathKey.
+ * @brief The paths between two vertices: a range of indices in the path arena.
  */
 typedef struct {
     PathKey key;
-    int **path_list;
-    int count;
-    int capacity;
-    UT_hash_handle hh;
+    size_t first;       // Index of the first path
+    int count;          // Number of paths, stored at consecutive indices
 } PathMapEntry;
 
+// The first arena chunk holds 2^PATH_CHUNK_BITS paths, every further one twice as many
+#define PATH_CHUNK_BITS 6
+#define PATH_MAX_CHUNKS 48
+
+// Marks a free slot of the key table; no packed key has every bit set
+#define PATH_KEY_EMPTY UINT64_MAX
+
+/**
+ * @brief The entries of the keys with one start: entries[first] up to entries[end].
+ */
+typedef struct {
+    int start, first, end;
+} PathStartRange;
+
+/**
+ * @brief All paths of one length, grouped by their start and end vertices.
+ *
+ * The paths are stored back to back, len + 1 vertices each, in an arena of
+ * chunks of doubling size, so they are allocated and freed a chunk at a time
+ * and the paths of one key are adjacent in memory. A path is addressed by
+ * its index; every key has an entry holding its range of indices.
+ *
+ * The paths of one start are grouped by end vertex, so a map filled in order
+ * of start holds its paths sorted by start and grouped by (start, end). The
+ * entries are kept in an array; path_map_index_starts() groups them by start
+ * and lists the distinct starts with the range of their entries. An entry is
+ * found by an open-addressing table with linear probing over the packed
+ * 64-bit keys, held in an array of their own so a probe compares consecutive
+ * words, and kept at most half full.
+ */
+typedef struct {
+    int len;                            // Edges per path
+    size_t count;                       // Number of paths stored
+    int chunk_count;                    // Number of chunks allocated
+    int *chunks[PATH_MAX_CHUNKS];
+    PathMapEntry *entries;              // One per key
+    int key_count;
+    int key_capacity;
+    uint64_t *table_keys;               // Packed keys, PATH_KEY_EMPTY if free
+    int *table_entries;                 // Entry of the key in the same slot
+    int table_bits;                     // log2 of the number of slots (0: no table yet)
+    int start_count;                    // Distinct starts, 0 until path_map_index_starts()
+    PathStartRange *start_ranges;       // Their entries, by increasing start
+} PathMap;
+
+/**
+ * @brief Returns the path with the given index (len + 1 vertices).
+ */
+static inline int* path_map_path(const PathMap *map, size_t i) {
+    // Chunk c starts at index (2^c - 1) << PATH_CHUNK_BITS
+    size_t slot = (i >> PATH_CHUNK_BITS) + 1;
+    int c = 63 - __builtin_clzll(slot);
+    size_t first = (((size_t)1 << c) - 1) << PATH_CHUNK_BITS;
+    return map->chunks[c] + (i - first) * (size_t)(map->len + 1);
+}
+
+/**
+ * @brief Packs a start and end vertex into one table key.
+ */
+static inline uint64_t path_key_pack(int start, int end) {
+    return (uint64_t)(uint32_t)start << 32 | (uint32_t)end;
+}
+
+/**
+ * @brief Home slot of a packed key: Fibonacci hashing, keeping the top bits.
+ */
+static inline size_t path_key_slot(uint64_t key, int bits) {
+    return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> (64 - bits));
+}
+
+/**
+ * @brief Returns the paths from start to end, or NULL if there are none.
+ */
+static inline const PathMapEntry* path_map_find(const PathMap *map, int start, int end) {
+    if (map->table_bits == 0) return NULL;
+    uint64_t key = path_key_pack(start, end);
+    size_t mask = ((size_t)1 << map->table_bits) - 1;
+    for (size_t slot = path_key_slot(key, map->table_bits); ; slot = (slot + 1) & mask) {
+        uint64_t k = map->table_keys[slot];
+        if (k == key) return &map->entries[map->table_entries[slot]];
+        if (k == PATH_KEY_EMPTY) return NULL;
+    }
+}
+
+/**
+ * @brief Finds the entries of the keys starting at v.
+ *
+ * Takes O(log starts), a binary search over the distinct starts. The ends of
+ * the entries in the range are not sorted.
+ *
+ * @param map   A map indexed by path_map_index_starts().
+ * @param v     The start vertex.
+ * @param first Receives the first entry of v.
+ * @return      One past the last entry of v; equal to *first if v starts no path.
+ */
+static inline int path_map_start_range(const PathMap *map, int v, int *first) {
+    int lo = 0, hi = map->start_count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (map->start_ranges[mid].start < v) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == map->start_count || map->start_ranges[lo].start != v) {
+        *first = 0;
+        return 0;
+    }
+    *first = map->start_ranges[lo].first;
+    return map->start_ranges[lo].end;
+}
+
+/**
+ * @brief Groups the entries by start and lists the distinct starts.
+ *
+ * The runs of entries with the same start are listed and sorted by start;
+ * only if a start has more than one run are the entries themselves sorted by
+ * (start, end). Otherwise the entries of a start keep the order in which
+ * their keys first appeared, so callers must not rely on sorted ends.
+ * Afterwards path_map_start_range() gives the keys starting at a vertex in
+ * O(log starts). The list takes space in proportion to the number of keys,
+ * not of vertices, and a map filled in order of start needs no sort at all.
+ * Maps built by get_paths() are indexed already; other maps must be indexed
+ * again after paths were added or the map was reversed.
+ *
+ * @param map   The map of paths.
+ * @return      1 on success, 0 on allocation failure.
+ */
+int path_map_index_starts(PathMap *map);
+
+/**
+ * @brief Creates an empty map for paths of len edges.
+ *
+ * @param len   The length of the paths (number of edges).
+ * @return      The map, or NULL on allocation failure.
+ */
+PathMap* path_map_new(int len);
+
+/**
+ * @brief Scratch space of the path search, reused for every start of a graph.
+ *
+ * Holds the path being extended, one neighbor cursor per level and one bit
+ * per vertex marking the vertices on the path, plus the buffers used to
+ * group the paths of a start by their end vertex.
+ */
+typedef struct {
+    int *path;
+    struct PathCursor *cursors;
+    uint64_t *on_path;
+    int *group_paths;                   // Paths of the start being filed, in found order
+    size_t group_capacity;
+    int max_len;
+} PathSearch;
+
+/**
+ * @brief Allocates the scratch space to search paths of up to max_len edges.
+ *
+ * @param n         Number of vertices of the graphs searched.
+ * @param max_len   Longest path searched (number of edges).
+ * @return          The scratch space, or NULL on allocation failure.
+ */
+PathSearch* path_search_new(int n, int max_len);
+
+/**
+ * @brief Frees the scratch space of the path search.
+ */
+void path_search_free(PathSearch *search);
+
 /**
  * @brief Finds all simple paths of length 'len' in the graph.
  *
- * @param adj         The adjacency matrix of the graph.
- * @param degrees     Array of vertex degrees (used to skip isolated vertices).
- * @param n_vertices  Number of vertices in the graph.
+ * With a positive cyclesize, only paths that can be part of a cycle of that
+ * length are kept: a breadth-first search against the arcs gives the distance
+ * from every vertex back to the start, and the search does not enter a vertex
+ * reached after d arcs that is more than cyclesize - d arcs away from the start.
+ *
+ * @param g           The graph (its degrees are used to skip isolated vertices).
  * @param len         The exact length of paths to find (number of edges).
+ * @param cyclesize   Length of the cycles the paths are joined into, or 0 to keep every path.
  * @param path_count  Pointer to integer where number of paths found can be stored
- * @return            A hash map of paths keyed by start and end vertices.
+ * @return            The paths grouped by start and end vertices and indexed by start,
+ *                    or NULL on allocation failure.
+ */
+PathMap* get_paths(const Graph *g, int len, int cyclesize, int *path_count);
+
+/**
+ * @brief Adds all simple paths of the map's length that start at one vertex to a map.
+ *
+ * Every start may only be searched once into the same map, as the paths of
+ * a key must be stored at consecutive indices.
+ *
+ * @param g           The graph.
+ * @param search      Scratch space for paths of at least map->len edges over g->n vertices.
+ * @param start       First vertex of every path.
+ * @param floor       Only vertices above floor are visited after the start (-1: any).
+ * @param map         The map receiving the paths.
+ * @param path_count  Incremented for every path added.
+ * @return            1 on success, 0 on allocation failure.
+ */
+int add_paths_from(const Graph *g, PathSearch *search, int start, int floor,
+                   PathMap *map, int *path_count);
+
+/**
+ * @brief Reverses every path of a map, so that a path from u to v becomes one from v to u.
+ *
+ * Paths found on the transposed graph become paths of the graph itself; paths
+ * of an undirected graph that start at a vertex become paths that end there.
+ *
+ * The paths are reversed in place and keep their indices. The index by start
+ * is dropped.
+ *
+ * @param map   The map of paths.
  */
-PathMapEntry* get_paths(int **adj, int *degrees, int n_vertices, int len, int *path_count);
+void reverse_path_map(PathMap *map);
 
 /**
- * @brief Prints all paths stored in the given PathMapEntry map.
+ * @brief Prints all paths stored in the given map.
  *
- * @param paths The map of paths to print.
- * @param len   The length of each path (number of edges).
+ * @param map   The map of paths to print.
  */
-void print_path_map(PathMapEntry *paths, int len);
+void print_path_map(const PathMap *map);
 
 /**
- * @brief Frees all memory associated with the PathMapEntry map.
+ * @brief Frees the map, its index and its arena chunks.
  *
- * @param paths The map of paths to free.
+ * @param map   The map of paths to free (may be NULL).
  */
-void free_path_map(PathMapEntry *paths);
+void free_path_map(PathMap *map);
 
 #endif // PATHS_H
\ No newline at end of file
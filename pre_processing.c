@@ -24,40 +24,299 @@
 
 // pre_processing.c
 #include "pre_processing.h"
+#include "parallel.h"
+#include <limits.h>
 
-// Iteratively removes all vertices of degree 1 until no such vertex remains.
-// The result is a pruned version of the graph, known as its 2-core.
-int* twocores(int** adj, int *degrees, int num_vertices, int directed) {
-    int changed = 1;
-
-    while (changed == 1) {
-        changed = 0;
-        for (int i = 0; i < num_vertices; i++) {
-            if (degrees[i] == 1) {
-                for (int j = 0; j < num_vertices; j++) {
-                    if (adj[i][j] == 1) {
-                        // Remove edge i -> j
-                        changed = 1;
-                        adj[i][j] = 0;
-                        degrees[i]--;
-                        degrees[j]--;
-
-                        if (!directed) {
-                            adj[j][i] = 0;
-                        }
-                        break;
-                    } else if (directed && adj[j][i] == 1) {
-                        // Remove edge j -> i (for directed case)
-                        changed = 1;
-                        adj[j][i] = 0;
-                        degrees[j]--;
-                        degrees[i]--;
-                        break;
-                    }
+// Calls body with w bound to every neighbor of u, over both rows of a directed graph
+#define FOR_EACH_NEIGHBOR(g, u, w, body)                                         \
+    do {                                                                         \
+        for (size_t _e = (g)->offsets[u]; _e < (g)->offsets[(u) + 1]; _e++) {   \
+            int w = (g)->neighbors[_e];                                          \
+            body                                                                 \
+        }                                                                        \
+        if ((g)->directed) {                                                     \
+            for (size_t _e = (g)->in_offsets[u]; _e < (g)->in_offsets[(u) + 1]; _e++) { \
+                int w = (g)->in_neighbors[_e];                                   \
+                body                                                             \
+            }                                                                    \
+        }                                                                        \
+    } while (0)
+
+// Peels vertices in order of increasing current degree. Vertices are kept in
+// vert sorted by degree, with bin[d] the first position of degree d; lowering
+// the degree of a neighbor swaps it to the front of its bucket.
+int* core_numbers(const Graph *g) {
+    int n = g->n;
+    int max_degree = 0;
+    for (int v = 0; v < n; v++) {
+        if (g->degrees[v] > max_degree) max_degree = g->degrees[v];
+    }
+
+    int *core = malloc((n ? n : 1) * sizeof(int));
+    int *bin = calloc(max_degree + 1, sizeof(int));
+    int *pos = malloc((n ? n : 1) * sizeof(int));
+    int *vert = malloc((n ? n : 1) * sizeof(int));
+    if (!core || !bin || !pos || !vert) {
+        free(core);
+        free(bin);
+        free(pos);
+        free(vert);
+        return NULL;
+    }
+
+    // Bucket sort the vertices by degree
+    for (int v = 0; v < n; v++) {
+        core[v] = g->degrees[v];
+        bin[core[v]]++;
+    }
+    int start = 0;
+    for (int d = 0; d <= max_degree; d++) {
+        int count = bin[d];
+        bin[d] = start;
+        start += count;
+    }
+    for (int v = 0; v < n; v++) {
+        pos[v] = bin[core[v]]++;
+        vert[pos[v]] = v;
+    }
+    for (int d = max_degree; d > 0; d--) bin[d] = bin[d - 1];
+    bin[0] = 0;
+
+    for (int i = 0; i < n; i++) {
+        int v = vert[i];
+        FOR_EACH_NEIGHBOR(g, v, u, {
+            if (core[u] > core[v]) {
+                // Move u to the front of its bucket and shrink the bucket
+                int du = core[u];
+                int pu = pos[u];
+                int pw = bin[du];
+                int w = vert[pw];
+                if (u != w) {
+                    pos[u] = pw;
+                    vert[pu] = w;
+                    pos[w] = pu;
+                    vert[pw] = u;
                 }
+                bin[du]++;
+                core[u]--;
+            }
+        });
+    }
+
+    free(bin);
+    free(pos);
+    free(vert);
+    return core;
+}
+
+// Drops every vertex whose core number is below k and recounts the arcs of
+// the remaining ones.
+int* kcores(Graph *g, int k) {
+    int *core = core_numbers(g);
+    if (!core) return NULL;
+
+    int *degrees = g->degrees;
+    for (int v = 0; v < g->n; v++) {
+        if (core[v] < k) {
+            degrees[v] = 0;
+            continue;
+        }
+        int remaining = 0;
+        FOR_EACH_NEIGHBOR(g, v, u, {
+            remaining += core[u] >= k;
+        });
+        degrees[v] = remaining;
+    }
+    free(core);
+
+    // Physically drop the arcs of removed vertices
+    graph_prune(g);
+
+    return degrees;
+}
+
+// Queues every vertex that lost its last in- or out-arc and removes its arcs
+// from the counts of its neighbors, so every arc is visited at most twice.
+int* peel_sources_sinks(Graph *g) {
+    int n = g->n;
+    int *out = malloc((n ? n : 1) * sizeof(int));
+    int *in = malloc((n ? n : 1) * sizeof(int));
+    int *queue = malloc((n ? n : 1) * sizeof(int));
+    unsigned char *removed = calloc(n ? n : 1, 1);
+    if (!out || !in || !queue || !removed) {
+        free(out);
+        free(in);
+        free(queue);
+        free(removed);
+        return NULL;
+    }
+
+    int tail = 0;
+    for (int v = 0; v < n; v++) {
+        out[v] = (int)(g->offsets[v + 1] - g->offsets[v]);
+        in[v] = (int)(g->in_offsets[v + 1] - g->in_offsets[v]);
+        if (g->degrees[v] > 0 && (out[v] == 0 || in[v] == 0)) {
+            removed[v] = 1;
+            queue[tail++] = v;
+        }
+    }
+
+    for (int head = 0; head < tail; head++) {
+        int v = queue[head];
+        for (size_t e = g->offsets[v]; e < g->offsets[v + 1]; e++) {
+            int w = g->neighbors[e];
+            if (!removed[w] && --in[w] == 0) {
+                removed[w] = 1;
+                queue[tail++] = w;
+            }
+        }
+        for (size_t e = g->in_offsets[v]; e < g->in_offsets[v + 1]; e++) {
+            int w = g->in_neighbors[e];
+            if (!removed[w] && --out[w] == 0) {
+                removed[w] = 1;
+                queue[tail++] = w;
             }
         }
     }
 
+    int *degrees = g->degrees;
+    for (int v = 0; v < n; v++) degrees[v] = removed[v] ? 0 : out[v] + in[v];
+    free(out);
+    free(in);
+    free(queue);
+    free(removed);
+
+    // Physically drop the arcs of removed vertices
+    graph_prune(g);
+
     return degrees;
 }
+
+// Removes all vertices of degree 1 until no such vertex remains.
+// The result is a pruned version of the graph, known as its 2-core.
+// A directed graph also loses its sources and sinks.
+int* twocores(Graph *g) {
+    if (g->directed) return peel_sources_sinks(g);
+    return kcores(g, 2);
+}
+// Shared state of the bounded searches of one pruning round
+typedef struct {
+    const Graph *g;
+    int k;
+    unsigned char *removed;     // One flag per stored arc
+} ArcCheck;
+
+// Returns non-zero if target is reached from source within max_depth arcs
+// without following the arc source -> skip (skip < 0: none). seen holds the
+// stamp of the vertices already queued.
+static int within_reach(const Graph *g, int source, int target, int skip, int max_depth,
+                        int *queue, int *seen, int stamp) {
+    int head = 0, tail = 0;
+    queue[tail++] = source;
+    seen[source] = stamp;
+    for (int depth = 1; depth <= max_depth && head < tail; depth++) {
+        int level_end = tail;
+        while (head < level_end) {
+            int x = queue[head++];
+            for (size_t e = g->offsets[x]; e < g->offsets[x + 1]; e++) {
+                int w = g->neighbors[e];
+                if (seen[w] == stamp || (x == source && w == skip)) continue;
+                if (w == target) return 1;
+                seen[w] = stamp;
+                queue[tail++] = w;
+            }
+        }
+    }
+    return 0;
+}
+
+// Checks the arcs in this thread's share of the rows. An undirected edge
+// {u, v} is checked once, from u < v, for a path of at most k - 1 edges that
+// avoids it; an arc u -> v needs a path back from v to u of at most k - 1 arcs.
+static void check_arcs_task(void *ctx, int thread, int threads) {
+    ArcCheck *c = ctx;
+    const Graph *g = c->g;
+    int n = g->n;
+    int *queue = malloc((n ? n : 1) * sizeof(int));
+    int *seen = malloc((n ? n : 1) * sizeof(int));
+    if (!queue || !seen) {
+        // Keep every arc of this share
+        free(queue);
+        free(seen);
+        return;
+    }
+    for (int v = 0; v < n; v++) seen[v] = 0;
+
+    // Split by arcs rather than vertices, as a few rows hold most of them
+    size_t lo = parallel_slice(g->m, thread, threads), hi = parallel_slice(g->m, thread + 1, threads);
+    int u = 0, last = n, stamp = 0;
+    while (u < last) {
+        int mid = u + (last - u) / 2;
+        if (g->offsets[mid + 1] <= lo) u = mid + 1;
+        else last = mid;
+    }
+
+    for (size_t e = lo; e < hi; e++) {
+        while (g->offsets[u + 1] <= e) u++;
+        if (stamp == INT_MAX) {
+            for (int v = 0; v < n; v++) seen[v] = 0;
+            stamp = 0;
+        }
+        int v = g->neighbors[e];
+        int kept;
+        if (g->directed) {
+            kept = within_reach(g, v, u, -1, c->k - 1, queue, seen, ++stamp);
+        } else if (u < v) {
+            kept = within_reach(g, u, v, v, c->k - 1, queue, seen, ++stamp);
+        } else {
+            continue;
+        }
+        c->removed[e] = !kept;
+    }
+
+    free(queue);
+    free(seen);
+}
+
+// Searches every arc in parallel, mirrors the verdicts of undirected edges to
+// their second direction, drops the arcs and peels the graph again with
+// twocores(). Rounds repeat while arcs are removed, as every removal
+// can only lengthen the remaining shortest paths.
+int length_prune(Graph *g, int k, int threads, size_t *removed_edges) {
+    *removed_edges = 0;
+    // An undirected cycle needs at least three edges
+    if (!g->directed && k < 3) return 1;
+
+    size_t removed;
+    do {
+        unsigned char *removed_arcs = calloc(g->m ? g->m : 1, 1);
+        if (!removed_arcs) return 0;
+
+        ArcCheck check = {g, k, removed_arcs};
+        parallel_run(threads, check_arcs_task, &check);
+
+        if (!g->directed) {
+            for (int u = 0; u < g->n; u++) {
+                for (size_t e = g->offsets[u]; e < g->offsets[u + 1]; e++) {
+                    int v = g->neighbors[e];
+                    if (v >= u) break;
+                    // Position of u in the sorted row of v
+                    size_t lo = g->offsets[v], hi = g->offsets[v + 1];
+                    while (lo < hi) {
+                        size_t mid = lo + (hi - lo) / 2;
+                        if (g->neighbors[mid] < u) lo = mid + 1;
+                        else hi = mid;
+                    }
+                    removed_arcs[e] = removed_arcs[lo];
+                }
+            }
+        }
+
+        removed = graph_remove_arcs(g, removed_arcs);
+        free(removed_arcs);
+        *removed_edges += g->directed ? removed : removed / 2;
+        if (removed && !twocores(g)) return 0;
+    } while (removed);
+
+    return 1;
+}
@@ -29,18 +29,79 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "graph.h"
+
+/**
+ * @brief Computes the core number of every vertex (Batagelj-Zaversnik).
+ *
+ * The core number of a vertex is the largest k such that it belongs to the
+ * k-core, the maximal subgraph in which every vertex has degree at least k.
+ * Vertices are peeled in order of their current degree using bucket lists, so
+ * every arc is visited a constant number of times: O(n + m).
+ *
+ * @param g             The graph; degrees are taken from g->degrees.
+ * @return              Newly allocated array of n core numbers, or NULL on allocation failure.
+ */
+int* core_numbers(const Graph *g);
+
+/**
+ * @brief Prunes the graph to its k-core.
+ *
+ * Vertices with a core number below k lose all their arcs and get degree 0;
+ * the degrees of the remaining vertices are reduced accordingly.
+ *
+ * @param g             The graph, pruned to its k-core on return.
+ * @param k             Minimum degree of the remaining vertices.
+ * @return              Pointer to the updated degrees array (g->degrees), or NULL on
+ *                      allocation failure, in which case the graph is left unchanged.
+ */
+int* kcores(Graph *g, int k);
+
+/**
+ * @brief Iteratively removes every vertex of a directed graph without in-arcs or out-arcs.
+ *
+ * Such a vertex cannot lie on a directed cycle, however many arcs it has in the
+ * other direction. Removing it may turn its neighbors into sources or sinks, so
+ * the vertices are peeled from a queue while in- and out-degrees are counted
+ * down: O(n + m). Removed vertices get degree 0 and lose their arcs.
+ *
+ * @param g             The directed graph, pruned on return (not GRAPH_COMPRESSED).
+ * @return              Pointer to the updated degrees array (g->degrees), or NULL on
+ *                      allocation failure, in which case the graph is left unchanged.
+ */
+int* peel_sources_sinks(Graph *g);
+
 /**
  * @brief Prunes all vertices of degree 1 from the graph iteratively to compute the 2-core.
  *
- * The function modifies the adjacency matrix and degree array in-place.
+ * The function modifies the graph and its degree array in-place.
  * In a 2-core, all vertices have degree at least 2 (or 0 if removed).
+ * Directed graphs are pruned with peel_sources_sinks() instead, which removes
+ * every vertex the 2-core would and also those with arcs in one direction only.
+ *
+ * @param g             The graph, pruned to its 2-core on return.
+ * @return              Pointer to the updated degrees array (g->degrees), or NULL on
+ *                      allocation failure.
+ */
+int* twocores(Graph *g);
+
+/**
+ * @brief Removes the edges that cannot lie on a cycle of length k.
+ *
+ * An edge {u, v} lies on a k-cycle only if u and v are joined by a path of at
+ * most k - 1 edges that avoids it; an arc u -> v only if there is a path of at
+ * most k - 1 arcs from v back to u. Every edge is checked with a breadth-first
+ * search bounded to that depth, on several threads. The failing edges are
+ * removed, the graph is peeled again with twocores() and the
+ * rounds repeat until no edge is removed. No cycle of length k is lost.
  *
- * @param adj           The adjacency matrix representing the graph.
- * @param degrees       Array of vertex degrees, updated in-place.
- * @param num_vertices  Total number of vertices in the graph.
- * @param directed      Non-zero if the graph is directed; 0 if undirected.
- * @return              Pointer to the updated degrees array (same as input).
+ * @param g             The graph; must not use GRAPH_COMPRESSED.
+ * @param k             Length of the cycles searched for.
+ * @param threads       Number of threads to use.
+ * @param removed_edges Receives the number of edges (arcs if directed) removed.
+ * @return              1 on success, 0 on allocation failure, in which case the
+ *                      edges removed in earlier rounds stay removed.
  */
-int* twocores(int** adj, int *degrees, int num_vertices, int directed);
+int length_prune(Graph *g, int k, int threads, size_t *removed_edges);
 
 #endif // PRE_PROCESSING_H
\ No newline at end of file
@@ -0,0 +1,336 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Marco Blok
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// reorder.c
+#include "reorder.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Number of most recently placed vertices Gorder scores candidates against
+#define GORDER_WINDOW 5
+
+// Neighbors of vertices above this degree are not scored as siblings,
+// which keeps Gorder's cost bounded on graphs with hubs
+#define GORDER_HUB_DEGREE 256
+
+// Runs body with w bound to every out- and (for directed graphs) in-neighbor of u.
+#define FOR_EACH_NEIGHBOR(g, u, w, body)                                         \
+    do {                                                                         \
+        for (size_t _e = (g)->offsets[u]; _e < (g)->offsets[(u) + 1]; _e++) {   \
+            int w = (g)->neighbors[_e];                                          \
+            body                                                                 \
+        }                                                                        \
+        if ((g)->directed) {                                                     \
+            for (size_t _e = (g)->in_offsets[u]; _e < (g)->in_offsets[(u) + 1]; _e++) { \
+                int w = (g)->in_neighbors[_e];                                   \
+                body                                                             \
+            }                                                                    \
+        }                                                                        \
+    } while (0)
+
+// Sorts 64-bit keys in place (insertion sort for short runs, else quicksort).
+static void sort_keys(uint64_t *a, size_t len) {
+    while (len > 16) {
+        uint64_t pivot = a[len / 2];
+        size_t i = 0, j = len - 1;
+        for (;;) {
+            while (a[i] < pivot) i++;
+            while (a[j] > pivot) j--;
+            if (i >= j) break;
+            uint64_t tmp = a[i];
+            a[i] = a[j];
+            a[j] = tmp;
+            i++;
+            j--;
+        }
+        sort_keys(a, j + 1);
+        a += j + 1;
+        len -= j + 1;
+    }
+    for (size_t i = 1; i < len; i++) {
+        uint64_t x = a[i];
+        size_t j = i;
+        while (j > 0 && a[j - 1] > x) {
+            a[j] = a[j - 1];
+            j--;
+        }
+        a[j] = x;
+    }
+}
+
+// Sorts the vertices with non-zero degree by degree with a counting sort, ties
+// broken by id, and appends the degree-0 vertices. Returns the number of
+// vertices with non-zero degree, or -1 on allocation failure.
+static int sort_by_degree(const int *degrees, int n, int descending, int *out) {
+    int max_degree = 0;
+    for (int v = 0; v < n; v++) {
+        if (degrees[v] > max_degree) max_degree = degrees[v];
+    }
+
+    int *start = calloc(max_degree + 2, sizeof(int));
+    if (!start) return -1;
+    for (int v = 0; v < n; v++) {
+        if (degrees[v] == 0) continue;
+        int d = descending ? max_degree - degrees[v] : degrees[v];
+        start[d + 1]++;
+    }
+    for (int d = 0; d <= max_degree; d++) start[d + 1] += start[d];
+
+    int active = start[max_degree + 1];
+    int tail = active;
+    for (int v = 0; v < n; v++) {
+        if (degrees[v] == 0) {
+            out[tail++] = v;
+            continue;
+        }
+        int d = descending ? max_degree - degrees[v] : degrees[v];
+        out[start[d]++] = v;
+    }
+
+    free(start);
+    return active;
+}
+
+// Degree-descending order.
+static int order_degree(const int *degrees, int n, int *order) {
+    return sort_by_degree(degrees, n, 1, order) >= 0;
+}
+
+// Reverse Cuthill-McKee: BFS from a minimum-degree vertex of every component,
+// visiting new neighbors by increasing degree, then reverse the visit order.
+static int order_rcm(const Graph *g, const int *degrees, int *order) {
+    int n = g->n;
+    int *by_degree = malloc(n * sizeof(int));
+    char *visited = calloc(n, 1);
+    uint64_t *batch = malloc((g->directed ? 2 : 1) * (g->m ? g->m : 1) * sizeof(uint64_t));
+    int active = by_degree ? sort_by_degree(degrees, n, 0, by_degree) : -1;
+    if (active < 0 || !visited || !batch) {
+        free(by_degree);
+        free(visited);
+        free(batch);
+        return 0;
+    }
+
+    int head = 0, tail = 0;
+    for (int s = 0; s < active; s++) {
+        int start = by_degree[s];
+        if (visited[start]) continue;
+        visited[start] = 1;
+        order[tail++] = start;
+
+        while (head < tail) {
+            int u = order[head++];
+            size_t found = 0;
+            FOR_EACH_NEIGHBOR(g, u, w, {
+                if (!visited[w]) {
+                    visited[w] = 1;
+                    batch[found++] = ((uint64_t)degrees[w] << 32) | (uint32_t)w;
+                }
+            });
+            sort_keys(batch, found);
+            for (size_t i = 0; i < found; i++) order[tail++] = (int)(uint32_t)batch[i];
+        }
+    }
+
+    // Reverse the active part, degree-0 vertices stay at the end
+    for (int i = 0, j = tail - 1; i < j; i++, j--) {
+        int tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+    for (int s = active; s < n; s++) order[tail++] = by_degree[s];
+
+    free(by_degree);
+    free(visited);
+    free(batch);
+    return 1;
+}
+
+// Priority queue over unplaced vertices with unit increments and decrements:
+// one doubly-linked bucket per score.
+typedef struct {
+    int *score;
+    int *prev;
+    int *next;
+    int *head;          // First vertex of each score bucket, -1 if empty
+    int buckets;
+    int top;            // Upper bound on the highest non-empty bucket
+} UnitHeap;
+
+static void heap_unlink(UnitHeap *h, int v) {
+    if (h->prev[v] >= 0) h->next[h->prev[v]] = h->next[v];
+    else h->head[h->score[v]] = h->next[v];
+    if (h->next[v] >= 0) h->prev[h->next[v]] = h->prev[v];
+}
+
+static int heap_link(UnitHeap *h, int v) {
+    int s = h->score[v];
+    if (s >= h->buckets) {
+        int buckets = h->buckets * 2 > s + 1 ? h->buckets * 2 : s + 1;
+        int *grown = realloc(h->head, buckets * sizeof(int));
+        if (!grown) return 0;
+        for (int i = h->buckets; i < buckets; i++) grown[i] = -1;
+        h->head = grown;
+        h->buckets = buckets;
+    }
+    h->prev[v] = -1;
+    h->next[v] = h->head[s];
+    if (h->head[s] >= 0) h->prev[h->head[s]] = v;
+    h->head[s] = v;
+    if (s > h->top) h->top = s;
+    return 1;
+}
+
+// Moves an unplaced vertex to score + delta.
+static int heap_adjust(UnitHeap *h, int v, int delta) {
+    heap_unlink(h, v);
+    h->score[v] += delta;
+    return heap_link(h, v);
+}
+
+static int heap_pop_max(UnitHeap *h) {
+    while (h->top >= 0 && h->head[h->top] < 0) h->top--;
+    if (h->top < 0) return -1;
+    int v = h->head[h->top];
+    heap_unlink(h, v);
+    return v;
+}
+
+// Adds (delta = 1) or removes (delta = -1) the contribution of placed vertex u
+// to the scores of unplaced vertices: its neighbors and its siblings.
+static int gorder_update(const Graph *g, UnitHeap *h, const char *placed, int u, int delta) {
+    int ok = 1;
+    FOR_EACH_NEIGHBOR(g, u, x, {
+        if (!placed[x]) ok &= heap_adjust(h, x, delta);
+        int dx = (int)(g->offsets[x + 1] - g->offsets[x]);
+        if (dx <= GORDER_HUB_DEGREE) {
+            for (size_t e = g->offsets[x]; e < g->offsets[x + 1]; e++) {
+                int y = g->neighbors[e];
+                if (y != u && !placed[y]) ok &= heap_adjust(h, y, delta);
+            }
+        }
+    });
+    return ok;
+}
+
+// Gorder-style greedy ordering: repeatedly place the unplaced vertex that
+// shares the most neighbors with, or is adjacent to, the last GORDER_WINDOW
+// placed vertices.
+static int order_gorder(const Graph *g, const int *degrees, int *order) {
+    int n = g->n;
+    UnitHeap h = {0};
+    h.score = calloc(n, sizeof(int));
+    h.prev = malloc(n * sizeof(int));
+    h.next = malloc(n * sizeof(int));
+    h.buckets = 16;
+    h.head = malloc(h.buckets * sizeof(int));
+    char *placed = calloc(n, 1);
+    int ok = h.score && h.prev && h.next && h.head && placed;
+
+    if (ok) {
+        for (int i = 0; i < h.buckets; i++) h.head[i] = -1;
+        h.top = 0;
+
+        // Degree-0 vertices take no part and go last
+        int first = -1, tail = n;
+        for (int v = n - 1; v >= 0; v--) {
+            if (degrees[v] == 0) {
+                placed[v] = 1;
+                order[--tail] = v;
+            } else {
+                heap_link(&h, v);
+                if (first < 0 || degrees[v] >= degrees[first]) first = v;
+            }
+        }
+
+        // Start from the highest-degree vertex
+        int count = 0;
+        int v = first;
+        if (v >= 0) heap_unlink(&h, v);
+        while (ok && v >= 0) {
+            placed[v] = 1;
+            order[count++] = v;
+            ok &= gorder_update(g, &h, placed, v, 1);
+            if (count > GORDER_WINDOW) {
+                ok &= gorder_update(g, &h, placed, order[count - GORDER_WINDOW - 1], -1);
+            }
+            v = heap_pop_max(&h);
+        }
+    }
+
+    free(h.score);
+    free(h.prev);
+    free(h.next);
+    free(h.head);
+    free(placed);
+    return ok;
+}
+
+// Dispatches to the requested ordering.
+int* vertex_order(const Graph *g, VertexOrder kind, int *active) {
+    const int *degrees = g->degrees;
+    int *order = malloc((g->n ? g->n : 1) * sizeof(int));
+    if (!order) return NULL;
+
+    int ok = 0;
+    switch (kind) {
+        case ORDER_DEGREE: ok = order_degree(degrees, g->n, order); break;
+        case ORDER_RCM:    ok = order_rcm(g, degrees, order); break;
+        case ORDER_GORDER: ok = order_gorder(g, degrees, order); break;
+        default: {
+            int head = 0, tail = g->n;
+            for (int v = 0; v < g->n; v++) {
+                if (degrees[v] > 0) order[head++] = v;
+            }
+            for (int v = g->n - 1; v >= 0; v--) {
+                if (degrees[v] == 0) order[--tail] = v;
+            }
+            ok = 1;
+            break;
+        }
+    }
+
+    if (!ok) {
+        free(order);
+        return NULL;
+    }
+
+    *active = 0;
+    for (int v = 0; v < g->n; v++) {
+        if (degrees[v] > 0) (*active)++;
+    }
+    return order;
+}
+
+// Computes the ordering and relabels the graph with it, dropping the
+// vertices without arcs.
+int compact_graph(Graph *g, VertexOrder kind) {
+    int active;
+    int *order = vertex_order(g, kind, &active);
+    if (!order) return 0;
+
+    int ok = graph_relabel(g, order, active);
+    free(order);
+    return ok;
+}
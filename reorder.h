@@ -0,0 +1,68 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Marco Blok
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// reorder.h
+#ifndef REORDER_H
+#define REORDER_H
+
+#include "graph.h"
+
+/**
+ * @brief Vertex orderings that improve memory locality of the enumeration.
+ */
+typedef enum {
+    ORDER_NONE,     // Keep the ids of the input file
+    ORDER_DEGREE,   // Degree-descending: hubs share the first cache lines
+    ORDER_RCM,      // Reverse Cuthill-McKee: small bandwidth, neighbors get nearby ids
+    ORDER_GORDER    // Gorder-style greedy: vertices sharing neighbors get nearby ids
+} VertexOrder;
+
+/**
+ * @brief Computes a vertex ordering of the graph.
+ *
+ * Vertices with degree 0 are always placed after all other vertices.
+ *
+ * @param g         The graph (out- and in-neighbors are both considered).
+ * @param kind      Ordering to compute; ORDER_NONE keeps the current ids.
+ * @param active    Output parameter that receives the number of vertices with non-zero degree.
+ * @return          Allocated permutation where entry i is the current id of new vertex i,
+ *                  or NULL on allocation failure. Caller must free the array.
+ */
+int* vertex_order(const Graph *g, VertexOrder kind, int *active);
+
+/**
+ * @brief Renumbers the vertices with non-zero degree to 0 .. n' - 1 in the given order.
+ *
+ * Vertices without arcs (e.g. removed by the 2-core pruning, or ids that never
+ * occur in an edge) are dropped, so every array sized by the number of
+ * vertices downstream is sized by the compacted graph. Input ids are kept in
+ * the graph's orig_id array.
+ *
+ * @param g         Graph to compact.
+ * @param kind      Order of the surviving vertices.
+ * @return          1 on success, 0 on allocation failure (the graph is left unchanged).
+ */
+int compact_graph(Graph *g, VertexOrder kind);
+
+#endif // REORDER_H
\ No newline at end of file
@@ -0,0 +1,263 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Marco Blok
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// snapshot.c
+#include "snapshot.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SNAPSHOT_MAGIC "PJSNAP\0"
+
+#define SNAPSHOT_DIRECTED 1u
+#define SNAPSHOT_TWOCORE  2u
+#define SNAPSHOT_ORIG_ID  4u
+
+// On-disk header; every payload section that follows is padded to 8 bytes.
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t source_size;       // Size of the source graph file
+    int64_t source_mtime_sec;   // Modification time of the source graph file
+    int64_t source_mtime_nsec;
+    uint64_t n;
+    uint64_t m;
+    uint64_t payload_size;
+    uint64_t checksum;          // Over the payload
+    uint64_t header_checksum;   // Over the header, with this field zeroed
+} SnapshotHeader;
+
+static size_t pad8(size_t bytes) {
+    return (bytes + 7) & ~(size_t)7;
+}
+
+// Size of the payload of a graph with n vertices and m arcs.
+static size_t payload_size(uint64_t n, uint64_t m, uint32_t flags) {
+    size_t rows = pad8((n + 1) * sizeof(uint64_t)) + pad8(m * sizeof(int));
+    size_t vertices = pad8(n * sizeof(int)) * ((flags & SNAPSHOT_ORIG_ID) ? 2 : 1);
+    return rows * ((flags & SNAPSHOT_DIRECTED) ? 2 : 1) + vertices;
+}
+
+// Word-at-a-time checksum; a trailing partial word is zero-padded, matching
+// the zero padding of sections in the file.
+static uint64_t checksum_update(uint64_t h, const void *data, size_t bytes) {
+    const unsigned char *p = data;
+    size_t words = bytes / 8;
+
+    for (size_t i = 0; i < words; i++) {
+        uint64_t w;
+        memcpy(&w, p + i * 8, 8);
+        h = (h ^ w) * 0x100000001B3ULL;
+        h ^= h >> 29;
+    }
+    if (bytes % 8) {
+        uint64_t w = 0;
+        memcpy(&w, p + words * 8, bytes % 8);
+        h = (h ^ w) * 0x100000001B3ULL;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+// Reads the size and modification time of the source graph file.
+static int source_fingerprint(const char *source, SnapshotHeader *h) {
+    struct stat st;
+    if (stat(source, &st) != 0) return 0;
+    h->source_size = (uint64_t)st.st_size;
+    h->source_mtime_sec = (int64_t)st.st_mtim.tv_sec;
+    h->source_mtime_nsec = (int64_t)st.st_mtim.tv_nsec;
+    return 1;
+}
+
+// Writes one section followed by its zero padding and folds it into the checksum.
+static int write_section(FILE *out, const void *data, size_t bytes, uint64_t *h) {
+    static const char zeros[8] = {0};
+    size_t padding = pad8(bytes) - bytes;
+
+    if (bytes && fwrite(data, 1, bytes, out) != bytes) return 0;
+    if (padding && fwrite(zeros, 1, padding, out) != padding) return 0;
+    *h = checksum_update(*h, data, bytes);
+    return 1;
+}
+
+// Writes the snapshot to a temporary file, then renames it into place.
+int snapshot_write(const char *path, const char *source, const Graph *g, int twocore) {
+    if (sizeof(size_t) != sizeof(uint64_t)) return 0;
+
+    SnapshotHeader header = {0};
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.flags = (g->directed ? SNAPSHOT_DIRECTED : 0) | (twocore ? SNAPSHOT_TWOCORE : 0) |
+                   (g->orig_id ? SNAPSHOT_ORIG_ID : 0);
+    if (source && !source_fingerprint(source, &header)) return 0;
+    header.n = (uint64_t)g->n;
+    header.m = (uint64_t)g->m;
+    header.payload_size = payload_size(header.n, header.m, header.flags);
+
+    size_t tmp_len = strlen(path) + 32;
+    char *tmp = malloc(tmp_len);
+    if (!tmp) return 0;
+    snprintf(tmp, tmp_len, "%s.tmp.%ld", path, (long)getpid());
+
+    FILE *out = fopen(tmp, "wb");
+    if (!out) {
+        free(tmp);
+        return 0;
+    }
+
+    // Reserve the header, it is rewritten once the checksum is known
+    uint64_t h = 0;
+    int ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    size_t rows = (size_t)g->n + 1;
+
+    ok = ok && write_section(out, g->offsets, rows * sizeof(size_t), &h);
+    ok = ok && write_section(out, g->neighbors, g->m * sizeof(int), &h);
+    if (g->directed) {
+        ok = ok && write_section(out, g->in_offsets, rows * sizeof(size_t), &h);
+        ok = ok && write_section(out, g->in_neighbors, g->m * sizeof(int), &h);
+    }
+    ok = ok && write_section(out, g->degrees, (size_t)g->n * sizeof(int), &h);
+    if (g->orig_id) {
+        ok = ok && write_section(out, g->orig_id, (size_t)g->n * sizeof(int), &h);
+    }
+
+    header.checksum = h;
+    header.header_checksum = checksum_update(0, &header, sizeof(header));
+    ok = ok && fseek(out, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, out) == 1;
+    ok = (fclose(out) == 0) && ok;
+
+    if (ok) ok = rename(tmp, path) == 0;
+    if (!ok) remove(tmp);
+    free(tmp);
+    return ok;
+}
+
+// Maps the snapshot and validates header and size before use; the payload is
+// only read in full when it is verified.
+SnapshotStatus snapshot_load(const char *path, const char *source, int directed, int verify,
+                             Graph **graph, int *twocore) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return SNAPSHOT_MISSING;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SnapshotHeader) || sizeof(size_t) != sizeof(uint64_t)) {
+        close(fd);
+        return SNAPSHOT_INVALID;
+    }
+
+    size_t size = (size_t)st.st_size;
+    char *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return SNAPSHOT_INVALID;
+
+    SnapshotHeader header;
+    memcpy(&header, data, sizeof(header));
+    int stored_directed = (header.flags & SNAPSHOT_DIRECTED) != 0;
+
+    SnapshotStatus status = SNAPSHOT_OK;
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != SNAPSHOT_VERSION ||
+        header.n > (uint64_t)INT32_MAX ||
+        header.payload_size != payload_size(header.n, header.m, header.flags) ||
+        header.payload_size != size - sizeof(header)) {
+        status = SNAPSHOT_INVALID;
+    }
+
+    if (status == SNAPSHOT_OK) {
+        SnapshotHeader zeroed = header;
+        zeroed.header_checksum = 0;
+        if (checksum_update(0, &zeroed, sizeof(zeroed)) != header.header_checksum) status = SNAPSHOT_INVALID;
+    }
+    if (status == SNAPSHOT_OK && verify &&
+        checksum_update(0, data + sizeof(header), header.payload_size) != header.checksum) {
+        status = SNAPSHOT_INVALID;
+    }
+
+    if (status == SNAPSHOT_OK && stored_directed != (directed != 0)) status = SNAPSHOT_STALE;
+    if (status == SNAPSHOT_OK && source) {
+        SnapshotHeader now = {0};
+        if (!source_fingerprint(source, &now) ||
+            now.source_size != header.source_size ||
+            now.source_mtime_sec != header.source_mtime_sec ||
+            now.source_mtime_nsec != header.source_mtime_nsec) {
+            status = SNAPSHOT_STALE;
+        }
+    }
+
+    Graph *g = status == SNAPSHOT_OK ? calloc(1, sizeof(Graph)) : NULL;
+    if (!g) {
+        munmap(data, size);
+        return status == SNAPSHOT_OK ? SNAPSHOT_INVALID : status;
+    }
+
+    // Point the graph arrays into the mapping
+    char *p = data + sizeof(header);
+    size_t rows = (size_t)header.n + 1;
+    g->n = (int)header.n;
+    g->m = (size_t)header.m;
+    g->directed = stored_directed;
+    g->offsets = (size_t*)p;
+    p += pad8(rows * sizeof(size_t));
+    g->neighbors = (int*)p;
+    p += pad8(g->m * sizeof(int));
+    if (g->directed) {
+        g->in_offsets = (size_t*)p;
+        p += pad8(rows * sizeof(size_t));
+        g->in_neighbors = (int*)p;
+        p += pad8(g->m * sizeof(int));
+    }
+    g->degrees = (int*)p;
+    p += pad8((size_t)g->n * sizeof(int));
+    if (header.flags & SNAPSHOT_ORIG_ID) g->orig_id = (int*)p;
+    g->mapping = data;
+    g->mapping_size = size;
+
+    // Cheap bounds on the row offsets catch most unverified corruption
+    if (g->offsets[0] != 0 || g->offsets[g->n] != g->m ||
+        (g->directed && (g->in_offsets[0] != 0 || g->in_offsets[g->n] != g->m))) {
+        graph_free(g);
+        return SNAPSHOT_INVALID;
+    }
+    graph_use_backend(g, graph_pick_backend(g->n, g->m));
+
+    *graph = g;
+    *twocore = (header.flags & SNAPSHOT_TWOCORE) != 0;
+    return SNAPSHOT_OK;
+}
+
+// Checks the first bytes of the file for the snapshot magic.
+int is_snapshot(const char *path) {
+    char magic[8];
+    FILE *in = fopen(path, "rb");
+    if (!in) return 0;
+    int match = fread(magic, 1, sizeof(magic), in) == sizeof(magic) &&
+                memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0;
+    fclose(in);
+    return match;
+}
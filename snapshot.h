@@ -0,0 +1,89 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Marco Blok
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// snapshot.h
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "graph.h"
+
+#define SNAPSHOT_VERSION 3
+
+/**
+ * @brief Outcome of loading a snapshot.
+ */
+typedef enum {
+    SNAPSHOT_OK,        // Snapshot loaded
+    SNAPSHOT_MISSING,   // No snapshot file
+    SNAPSHOT_STALE,     // Source graph changed, or built for another direction
+    SNAPSHOT_INVALID    // Not a snapshot, other version or checksum mismatch
+} SnapshotStatus;
+
+/**
+ * @brief Writes the graph to a binary snapshot.
+ *
+ * The file holds a versioned header (including the size and modification time of
+ * the source graph file) followed by the CSR offsets, neighbors, the transposed
+ * arrays for directed graphs, the degrees and, for graphs with compacted ids, the
+ * input id of every vertex. The header and the payload have checksums of their
+ * own, computed while writing. It is written to a temporary
+ * file and renamed, so concurrent readers never see a partial file.
+ *
+ * @param path      Path of the snapshot to write.
+ * @param source    Path of the graph file the snapshot was built from.
+ * @param g         Graph to store.
+ * @param twocore   Non-zero if the graph has been pruned to its 2-core.
+ * @return          1 on success, 0 on failure.
+ */
+int snapshot_write(const char *path, const char *source, const Graph *g, int twocore);
+
+/**
+ * @brief Loads a snapshot by mapping it, without any parsing.
+ *
+ * The graph arrays point straight into the (private, copy-on-write) mapping, so
+ * later in-place pruning (which also lowers the degrees) still works. Only the
+ * header checksum, the sizes and the first and last row offsets are checked by
+ * default, so pages of the payload are only read once they are used. The rest
+ * of the payload is then assumed intact: a corrupt neighbor or offset inside
+ * the rows is only caught when verify is set.
+ *
+ * @param path      Path of the snapshot to load.
+ * @param source    Graph file the snapshot must match, or NULL to skip the staleness check.
+ * @param directed  Non-zero if a directed graph is expected.
+ * @param verify    Non-zero to also check the payload checksum, reading the whole file.
+ * @param graph     Output parameter that receives the graph.
+ * @param twocore   Output parameter that receives whether the stored graph is a 2-core.
+ * @return          SNAPSHOT_OK on success; graph is untouched otherwise.
+ */
+SnapshotStatus snapshot_load(const char *path, const char *source, int directed, int verify,
+                             Graph **graph, int *twocore);
+
+/**
+ * @brief Returns non-zero if the file starts with the snapshot magic.
+ *
+ * @param path      Path of the file to inspect.
+ */
+int is_snapshot(const char *path);
+
+#endif // SNAPSHOT_H
\ No newline at end of file
@@ -0,0 +1,93 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Marco Blok
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// varint.h
+#ifndef VARINT_H
+#define VARINT_H
+
+#include <stdint.h>
+
+/**
+ * @brief Maximum number of bytes of an encoded 32-bit value.
+ */
+#define VARINT_MAX_BYTES 5
+
+/**
+ * @brief Maps a signed value to an unsigned one so that small magnitudes stay small.
+ */
+static inline uint32_t zigzag_encode(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+/**
+ * @brief Inverse of zigzag_encode().
+ */
+static inline int32_t zigzag_decode(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+/**
+ * @brief Returns the number of bytes varint_put() writes for v.
+ */
+static inline int varint_size(uint32_t v) {
+    int bytes = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        bytes++;
+    }
+    return bytes;
+}
+
+/**
+ * @brief Writes v as a little-endian base-128 varint and returns the byte after it.
+ */
+static inline uint8_t* varint_put(uint8_t *p, uint32_t v) {
+    while (v >= 0x80) {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+/**
+ * @brief Reads a varint written by varint_put() and returns the byte after it.
+ */
+static inline const uint8_t* varint_get(const uint8_t *p, uint32_t *out) {
+    uint32_t v = *p++;
+    if (v < 0x80) {
+        *out = v;
+        return p;
+    }
+    v &= 0x7f;
+    for (int shift = 7;; shift += 7) {
+        uint32_t byte = *p++;
+        v |= (byte & 0x7f) << shift;
+        if (byte < 0x80) break;
+    }
+    *out = v;
+    return p;
+}
+
+#endif // VARINT_H
\ No newline at end of file